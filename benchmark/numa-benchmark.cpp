@@ -0,0 +1,98 @@
+
+/*
+ * MSDF ATLAS GENERATOR - NUMA SCALING BENCHMARK
+ * ---------------------------------------------
+ * Generates the same MSDF atlas of all glyphs of a font with and without NUMA affinity (-numa)
+ * at a fixed thread count and prints the best time of each out of several repetitions.
+ * The time includes the clearing of the atlas storage, where the memory is first touched.
+ *
+ * Usage: msdf-atlas-numa-benchmark <font file> [threads] [em size] [repetitions]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <vector>
+#include <msdf-atlas-gen/msdf-atlas-gen.h>
+
+using namespace msdf_atlas;
+
+#define DEFAULT_EM_SIZE 48
+#define DEFAULT_PX_RANGE 4
+#define DEFAULT_REPETITIONS 5
+
+/// Generates the atlas and returns the elapsed time in milliseconds
+static double generateAtlas(const std::vector<GlyphGeometry> &glyphs, int width, int height, int threadCount, bool numaAffinity) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    ImmediateAtlasGenerator<float, 3, msdfGenerator, BitmapAtlasStorage<byte, 3> > generator(width, height, threadCount, numaAffinity);
+    generator.setThreadCount(threadCount);
+    generator.setNumaAffinity(numaAffinity);
+    generator.generate(glyphs.data(), (int) glyphs.size());
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now()-start).count();
+}
+
+int main(int argc, const char *const *argv) {
+    if (argc < 2) {
+        fputs("用法：msdf-atlas-numa-benchmark <字体文件> [线程数] [em 尺寸] [重复次数]\n", stderr);
+        return 1;
+    }
+    int threadCount = argc > 2 ? atoi(argv[2]) : 0;
+    if (threadCount <= 0)
+        threadCount = getDefaultThreadCount();
+    double emSize = argc > 3 ? atof(argv[3]) : 0;
+    if (!(emSize > 0))
+        emSize = DEFAULT_EM_SIZE;
+    int repetitions = argc > 4 ? atoi(argv[4]) : 0;
+    if (repetitions <= 0)
+        repetitions = DEFAULT_REPETITIONS;
+
+    // Load and pack all glyphs of the font
+    std::vector<GlyphGeometry> glyphs;
+    {
+        msdfgen::FreetypeHandle *ft = msdfgen::initializeFreetype();
+        if (!ft) {
+            fputs("无法初始化 FreeType 库。\n", stderr);
+            return 1;
+        }
+        msdfgen::FontHandle *font = msdfgen::loadFont(ft, argv[1]);
+        if (!font) {
+            msdfgen::deinitializeFreetype(ft);
+            fprintf(stderr, "无法加载字体文件 \"%s\"。\n", argv[1]);
+            return 1;
+        }
+        unsigned glyphCount = 0;
+        msdfgen::getGlyphCount(glyphCount, font);
+        FontGeometry fontGeometry(&glyphs);
+        fontGeometry.loadGlyphRange(font, 1, 0, glyphCount, true, false);
+        msdfgen::destroyFont(font);
+        msdfgen::deinitializeFreetype(ft);
+    }
+    for (GlyphGeometry &glyph : glyphs)
+        glyph.edgeColoring(msdfgen::edgeColoringInkTrap, 3.0, 0);
+    TightAtlasPacker packer;
+    packer.setDimensionsConstraint(DimensionsConstraint::MULTIPLE_OF_FOUR_SQUARE);
+    packer.setScale(emSize);
+    packer.setPixelRange(DEFAULT_PX_RANGE);
+    packer.setMiterLimit(1);
+    packer.setThreadCount(threadCount);
+    if (packer.pack(glyphs.data(), (int) glyphs.size())) {
+        fputs("无法将字形打包到图集中。\n", stderr);
+        return 1;
+    }
+    int width = 0, height = 0;
+    packer.getDimensions(width, height);
+    printf("%d 个字形，图集尺寸 %d x %d，%d 个线程，%d 个 NUMA 节点\n", (int) glyphs.size(), width, height, threadCount, getNumaNodeCount());
+
+    // Alternate the two modes so that both are equally affected by the state of the system
+    double bestTime[2] = { -1, -1 };
+    for (int i = 0; i < repetitions; ++i) {
+        for (int numa = 0; numa < 2; ++numa) {
+            double time = generateAtlas(glyphs, width, height, threadCount, numa != 0);
+            if (bestTime[numa] < 0 || time < bestTime[numa])
+                bestTime[numa] = time;
+        }
+    }
+    printf("不使用 NUMA 亲和性：%.1f 毫秒\n", bestTime[0]);
+    printf("使用 NUMA 亲和性：  %.1f 毫秒（%.2f 倍）\n", bestTime[1], bestTime[0]/bestTime[1]);
+    return 0;
+}
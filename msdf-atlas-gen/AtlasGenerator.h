@@ -24,6 +24,11 @@ public:
     void rearrange(int width, int height, const Remap *remapping, int count);
     /// Resizes the atlas and keeps the generated pixels in place
     void resize(int width, int height);
+    /// (Optional, needed for concurrent insertion into DynamicAtlas) Appends glyphs to the layout without generating their bitmaps
+    void reserve(const GlyphGeometry *glyphs, int count);
+    /// (Optional, needed for concurrent insertion into DynamicAtlas) Generates bitmaps of reserved glyphs in the calling thread,
+    /// must be safe to call concurrently for different glyphs as long as the atlas is not resized or rearranged meanwhile
+    void render(const GlyphGeometry *glyphs, int count);
 
 };
 
@@ -23,6 +23,10 @@ public:
     AtlasStorage(const AtlasStorage &orig, int width, int height);
     /// Creates a copy with different dimensions and rearranges the pixels according to the remapping array
     AtlasStorage(const AtlasStorage &orig, int width, int height, const Remap *remapping, int count);
+    /// Optionally, the two constructors above may also be overloaded for an rvalue orig, which generators use when resizing or rearranging,
+    /// so that its memory can be reused (see BitmapAtlasStorage)
+    /// Optionally, setThreadCount(int threadCount, bool numaAffinity) may be implemented, which ImmediateAtlasGenerator calls with its own settings
+    /// before resizing or rearranging, so that the storage may use the same threads to do so
     /// Stores a subsection at x, y into the atlas storage. May be implemented for only some T, N
     template <typename T, int N>
     void put(int x, int y, const msdfgen::BitmapConstRef<T, N> &subBitmap);
@@ -12,19 +12,40 @@ class BitmapAtlasStorage {
 public:
     BitmapAtlasStorage();
     BitmapAtlasStorage(int width, int height);
+    /// Clears the bitmap with multiple threads by rows, with NUMA affinity in the same way as ImmediateAtlasGenerator assigns glyphs,
+    /// so that memory pages are first touched (and thereby allocated) on the NUMA node of the threads that will write them.
+    /// The thread count is also used for rearranging and passed on to copies
+    BitmapAtlasStorage(int width, int height, int threadCount, bool numaAffinity);
     explicit BitmapAtlasStorage(const msdfgen::BitmapConstRef<T, N> &bitmap);
     explicit BitmapAtlasStorage(msdfgen::Bitmap<T, N> &&bitmap);
     BitmapAtlasStorage(const BitmapAtlasStorage<T, N> &orig, int width, int height);
     BitmapAtlasStorage(const BitmapAtlasStorage<T, N> &orig, int width, int height, const Remap *remapping, int count);
+    /// Resizes in place if the new dimensions fit into the memory already allocated by orig, otherwise creates a copy
+    BitmapAtlasStorage(BitmapAtlasStorage<T, N> &&orig, int width, int height);
+    /// Rearranges in place if the new dimensions fit into the memory already allocated by orig, otherwise creates a copy.
+    /// In place, subsections are moved in an order that never overwrites unread pixels, and only those in cyclic dependencies are staged
+    BitmapAtlasStorage(BitmapAtlasStorage<T, N> &&orig, int width, int height, const Remap *remapping, int count);
     operator msdfgen::BitmapConstRef<T, N>() const;
     operator msdfgen::BitmapRef<T, N>();
     operator msdfgen::Bitmap<T, N>() &&;
     template <typename S>
     void put(int x, int y, const msdfgen::BitmapConstRef<S, N> &subBitmap);
     void get(int x, int y, const msdfgen::BitmapRef<T, N> &subBitmap) const;
+    /// Sets the number of threads and the NUMA affinity used to clear and rearrange the bitmap, which are also passed on to copies
+    void setThreadCount(int threadCount, bool numaAffinity = false);
 
 private:
+    /// Allocated memory, which may be larger than the current dimensions (width x height with stride N*width)
     msdfgen::Bitmap<T, N> bitmap;
+    int width, height;
+    int threadCount;
+    bool numaAffinity;
+
+    size_t capacity() const;
+    void clear();
+    void rearrangeInPlace(int origWidth, int origHeight, const Remap *remapping, int count);
+    void blitCropped(const msdfgen::BitmapConstRef<T, N> &orig);
+    void blitRemapped(const msdfgen::BitmapConstRef<T, N> &orig, const Remap *remapping, int count);
 
 };
 
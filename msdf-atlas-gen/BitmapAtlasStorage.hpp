@@ -2,64 +2,262 @@
 #include "BitmapAtlasStorage.h"
 
 #include <cstring>
+#include <vector>
 #include <algorithm>
 #include "bitmap-blit.h"
+#include "Workload.h"
 
 namespace msdf_atlas {
 
+/// Number of elements (T) that may be staged at once to break cyclic dependencies between subsections when rearranging in place
+#define BITMAP_ATLAS_STAGING_LIMIT 0x100000
+
 template <typename T, int N>
-BitmapAtlasStorage<T, N>::BitmapAtlasStorage() { }
+BitmapAtlasStorage<T, N>::BitmapAtlasStorage() : width(0), height(0), threadCount(1), numaAffinity(false) { }
 
 template <typename T, int N>
-BitmapAtlasStorage<T, N>::BitmapAtlasStorage(int width, int height) : bitmap(width, height) {
+BitmapAtlasStorage<T, N>::BitmapAtlasStorage(int width, int height) : bitmap(width, height), width(width), height(height), threadCount(1), numaAffinity(false) {
     memset((T *) bitmap, 0, sizeof(T)*N*width*height);
 }
 
 template <typename T, int N>
-BitmapAtlasStorage<T, N>::BitmapAtlasStorage(const msdfgen::BitmapConstRef<T, N> &bitmap) : bitmap(bitmap) { }
+BitmapAtlasStorage<T, N>::BitmapAtlasStorage(int width, int height, int threadCount, bool numaAffinity) : bitmap(width, height), width(width), height(height), threadCount(std::max(threadCount, 1)), numaAffinity(numaAffinity) {
+    clear();
+}
 
 template <typename T, int N>
-BitmapAtlasStorage<T, N>::BitmapAtlasStorage(msdfgen::Bitmap<T, N> &&bitmap) : bitmap((msdfgen::Bitmap<T, N> &&) bitmap) { }
+BitmapAtlasStorage<T, N>::BitmapAtlasStorage(const msdfgen::BitmapConstRef<T, N> &bitmap) : bitmap(bitmap), width(bitmap.width), height(bitmap.height), threadCount(1), numaAffinity(false) { }
 
 template <typename T, int N>
-BitmapAtlasStorage<T, N>::BitmapAtlasStorage(const BitmapAtlasStorage<T, N> &orig, int width, int height) : bitmap(width, height) {
-    memset((T *) bitmap, 0, sizeof(T)*N*width*height);
-    blit(bitmap, orig.bitmap, 0, 0, 0, 0, std::min(width, orig.bitmap.width()), std::min(height, orig.bitmap.height()));
+BitmapAtlasStorage<T, N>::BitmapAtlasStorage(msdfgen::Bitmap<T, N> &&bitmap) : width(bitmap.width()), height(bitmap.height()), threadCount(1), numaAffinity(false) {
+    this->bitmap = (msdfgen::Bitmap<T, N> &&) bitmap;
 }
 
 template <typename T, int N>
-BitmapAtlasStorage<T, N>::BitmapAtlasStorage(const BitmapAtlasStorage<T, N> &orig, int width, int height, const Remap *remapping, int count) : bitmap(width, height) {
-    memset((T *) bitmap, 0, sizeof(T)*N*width*height);
-    for (int i = 0; i < count; ++i) {
-        const Remap &remap = remapping[i];
-        blit(bitmap, orig.bitmap, remap.target.x, remap.target.y, remap.source.x, remap.source.y, remap.width, remap.height);
+BitmapAtlasStorage<T, N>::BitmapAtlasStorage(const BitmapAtlasStorage<T, N> &orig, int width, int height) : bitmap(width, height), width(width), height(height), threadCount(orig.threadCount), numaAffinity(orig.numaAffinity) {
+    clear();
+    blitCropped(orig);
+}
+
+template <typename T, int N>
+BitmapAtlasStorage<T, N>::BitmapAtlasStorage(const BitmapAtlasStorage<T, N> &orig, int width, int height, const Remap *remapping, int count) : bitmap(width, height), width(width), height(height), threadCount(orig.threadCount), numaAffinity(orig.numaAffinity) {
+    clear();
+    blitRemapped(orig, remapping, count);
+}
+
+template <typename T, int N>
+BitmapAtlasStorage<T, N>::BitmapAtlasStorage(BitmapAtlasStorage<T, N> &&orig, int width, int height) : width(width), height(height), threadCount(orig.threadCount), numaAffinity(orig.numaAffinity) {
+    if ((size_t) N*width*height > orig.capacity()) {
+        bitmap = msdfgen::Bitmap<T, N>(width, height);
+        clear();
+        blitCropped(msdfgen::BitmapConstRef<T, N>((const T *) orig.bitmap, orig.width, orig.height));
+        return;
+    }
+    bitmap = (msdfgen::Bitmap<T, N> &&) orig.bitmap;
+    T *pixels = (T *) bitmap;
+    int copyWidth = std::min(width, orig.width), copyHeight = std::min(height, orig.height);
+    // Rows move towards the end of memory if the stride grows and towards the beginning if it shrinks,
+    // so they are processed in the same direction to never overwrite a row that has not been moved yet
+    if (width > orig.width) {
+        for (int y = copyHeight-1; y >= 0; --y) {
+            memmove(pixels+N*width*y, pixels+N*orig.width*y, sizeof(T)*N*copyWidth);
+            memset(pixels+N*(width*y+copyWidth), 0, sizeof(T)*N*(width-copyWidth));
+        }
+    } else {
+        for (int y = 0; y < copyHeight; ++y)
+            memmove(pixels+N*width*y, pixels+N*orig.width*y, sizeof(T)*N*copyWidth);
+    }
+    memset(pixels+N*width*copyHeight, 0, sizeof(T)*N*width*(height-copyHeight));
+    orig.width = 0, orig.height = 0;
+}
+
+template <typename T, int N>
+BitmapAtlasStorage<T, N>::BitmapAtlasStorage(BitmapAtlasStorage<T, N> &&orig, int width, int height, const Remap *remapping, int count) : width(width), height(height), threadCount(orig.threadCount), numaAffinity(orig.numaAffinity) {
+    if ((size_t) N*width*height > orig.capacity()) {
+        bitmap = msdfgen::Bitmap<T, N>(width, height);
+        clear();
+        blitRemapped(orig, remapping, count);
+        return;
     }
+    bitmap = (msdfgen::Bitmap<T, N> &&) orig.bitmap;
+    rearrangeInPlace(orig.width, orig.height, remapping, count);
+    orig.width = 0, orig.height = 0;
 }
 
 template <typename T, int N>
 BitmapAtlasStorage<T, N>::operator msdfgen::BitmapConstRef<T, N>() const {
-    return bitmap;
+    return msdfgen::BitmapConstRef<T, N>((const T *) bitmap, width, height);
 }
 
 template <typename T, int N>
 BitmapAtlasStorage<T, N>::operator msdfgen::BitmapRef<T, N>() {
-    return bitmap;
+    return msdfgen::BitmapRef<T, N>((T *) bitmap, width, height);
 }
 
 template <typename T, int N>
 BitmapAtlasStorage<T, N>::operator msdfgen::Bitmap<T, N>() && {
-    return (msdfgen::Bitmap<T, N> &&) bitmap;
+    if (width == bitmap.width() && height == bitmap.height())
+        return (msdfgen::Bitmap<T, N> &&) bitmap;
+    return msdfgen::Bitmap<T, N>(msdfgen::BitmapConstRef<T, N>((const T *) bitmap, width, height));
 }
 
 template <typename T, int N>
 template <typename S>
 void BitmapAtlasStorage<T, N>::put(int x, int y, const msdfgen::BitmapConstRef<S, N> &subBitmap) {
-    blit(bitmap, subBitmap, x, y, 0, 0, subBitmap.width, subBitmap.height);
+    blit(msdfgen::BitmapRef<T, N>(*this), subBitmap, x, y, 0, 0, subBitmap.width, subBitmap.height);
 }
 
 template <typename T, int N>
 void BitmapAtlasStorage<T, N>::get(int x, int y, const msdfgen::BitmapRef<T, N> &subBitmap) const {
-    blit(subBitmap, bitmap, 0, 0, x, y, subBitmap.width, subBitmap.height);
+    blit(subBitmap, msdfgen::BitmapConstRef<T, N>(*this), 0, 0, x, y, subBitmap.width, subBitmap.height);
+}
+
+template <typename T, int N>
+void BitmapAtlasStorage<T, N>::setThreadCount(int threadCount, bool numaAffinity) {
+    this->threadCount = std::max(threadCount, 1);
+    this->numaAffinity = numaAffinity;
+}
+
+template <typename T, int N>
+size_t BitmapAtlasStorage<T, N>::capacity() const {
+    return (size_t) N*bitmap.width()*bitmap.height();
+}
+
+template <typename T, int N>
+void BitmapAtlasStorage<T, N>::clear() {
+    // Rows are touched first by the threads that will write them if NUMA affinity is enabled
+    T *pixels = (T *) bitmap;
+    int width = this->width;
+    Workload(height).setNumaAffinity(numaAffinity).finish([pixels, width](int y, int) -> bool {
+        memset(pixels+N*width*y, 0, sizeof(T)*N*width);
+        return true;
+    }, threadCount);
+}
+
+template <typename T, int N>
+void BitmapAtlasStorage<T, N>::rearrangeInPlace(int origWidth, int origHeight, const Remap *remapping, int count) {
+    // Memory is tracked by pixel index - sources are laid out with the original stride, targets with the new one
+    std::vector<bool> unread(capacity()/N), targeted(capacity()/N);
+    auto setRows = [](std::vector<bool> &mask, int x, int y, int w, int h, int stride, bool value) {
+        for (int row = 0; row < h; ++row) {
+            std::vector<bool>::iterator start = mask.begin()+((size_t) stride*(y+row)+x);
+            std::fill(start, start+w, value);
+        }
+    };
+    auto anyInRows = [](const std::vector<bool> &mask, int x, int y, int w, int h, int stride) -> bool {
+        for (int row = 0; row < h; ++row) {
+            std::vector<bool>::const_iterator start = mask.begin()+((size_t) stride*(y+row)+x);
+            if (std::find(start, start+w, true) != start+w)
+                return true;
+        }
+        return false;
+    };
+    // Subsections are cropped to both the original and the new dimensions in the same way as by blit
+    std::vector<Remap> remaps(remapping, remapping+count);
+    size_t maxArea = 0;
+    for (Remap &remap : remaps) {
+        int sx = remap.source.x, sy = remap.source.y, dx = remap.target.x, dy = remap.target.y;
+        int w = remap.width, h = remap.height;
+        if (dx < 0) w += dx, sx -= dx, dx = 0;
+        if (dy < 0) h += dy, sy -= dy, dy = 0;
+        if (sx < 0) w += sx, dx -= sx, sx = 0;
+        if (sy < 0) h += sy, dy -= sy, sy = 0;
+        remap.source.x = sx, remap.source.y = sy, remap.target.x = dx, remap.target.y = dy;
+        remap.width = std::max(0, std::min(w, std::min(width-dx, origWidth-sx)));
+        remap.height = std::max(0, std::min(h, std::min(height-dy, origHeight-sy)));
+        setRows(unread, remap.source.x, remap.source.y, remap.width, remap.height, origWidth, true);
+        setRows(targeted, remap.target.x, remap.target.y, remap.width, remap.height, width, true);
+        maxArea = std::max(maxArea, (size_t) remap.width*remap.height);
+    }
+
+    // A subsection is moved (through a buffer for one subsection) once its target holds no unread pixels of other subsections.
+    // Only when none can be moved, some are staged to break the cycles, which may exceed BITMAP_ATLAS_STAGING_LIMIT only by the one needed to progress
+    msdfgen::BitmapConstRef<T, N> source((const T *) bitmap, origWidth, origHeight);
+    msdfgen::BitmapRef<T, N> target((T *) bitmap, width, height);
+    std::vector<T> buffer((size_t) N*maxArea);
+    std::vector<T> staging;
+    std::vector<std::pair<int, size_t> > staged;
+    std::vector<int> pending, blocked;
+    pending.reserve(count);
+    for (int i = 0; i < count; ++i)
+        pending.push_back(i);
+    while (!(pending.empty() && staged.empty())) {
+        bool progress = false;
+        for (size_t i = 0; i < staged.size(); ) {
+            const Remap &remap = remaps[staged[i].first];
+            if (!anyInRows(unread, remap.target.x, remap.target.y, remap.width, remap.height, width)) {
+                blit(target, msdfgen::BitmapConstRef<T, N>(staging.data()+staged[i].second, remap.width, remap.height), remap.target.x, remap.target.y, 0, 0, remap.width, remap.height);
+                staged.erase(staged.begin()+i);
+                progress = true;
+            } else
+                ++i;
+        }
+        if (staged.empty())
+            staging.clear();
+        blocked.clear();
+        for (int index : pending) {
+            const Remap &remap = remaps[index];
+            setRows(unread, remap.source.x, remap.source.y, remap.width, remap.height, origWidth, false);
+            if (anyInRows(unread, remap.target.x, remap.target.y, remap.width, remap.height, width)) {
+                setRows(unread, remap.source.x, remap.source.y, remap.width, remap.height, origWidth, true);
+                blocked.push_back(index);
+                continue;
+            }
+            blit(msdfgen::BitmapRef<T, N>(buffer.data(), remap.width, remap.height), source, 0, 0, remap.source.x, remap.source.y, remap.width, remap.height);
+            blit(target, msdfgen::BitmapConstRef<T, N>(buffer.data(), remap.width, remap.height), remap.target.x, remap.target.y, 0, 0, remap.width, remap.height);
+            progress = true;
+        }
+        // The next pass visits the blocked subsections in reverse order, so that chains of moves in either direction finish in few passes
+        pending.assign(blocked.rbegin(), blocked.rend());
+        if (!progress) {
+            size_t stagedCount = 0;
+            do {
+                const Remap &remap = remaps[pending[stagedCount]];
+                size_t offset = staging.size();
+                staging.resize(offset+(size_t) N*remap.width*remap.height);
+                blit(msdfgen::BitmapRef<T, N>(staging.data()+offset, remap.width, remap.height), source, 0, 0, remap.source.x, remap.source.y, remap.width, remap.height);
+                setRows(unread, remap.source.x, remap.source.y, remap.width, remap.height, origWidth, false);
+                staged.push_back(std::make_pair(pending[stagedCount++], offset));
+            } while (stagedCount < pending.size() && staging.size()+(size_t) N*remaps[pending[stagedCount]].width*remaps[pending[stagedCount]].height <= BITMAP_ATLAS_STAGING_LIMIT);
+            pending.erase(pending.begin(), pending.begin()+stagedCount);
+        }
+    }
+
+    // Everything outside of the targets is cleared
+    T *pixels = (T *) bitmap;
+    for (int y = 0; y < height; ++y) {
+        std::vector<bool>::const_iterator row = targeted.begin()+(size_t) width*y;
+        for (int x = 0; x < width; ) {
+            int start = x;
+            while (x < width && !row[x])
+                ++x;
+            if (x > start)
+                memset(pixels+N*((size_t) width*y+start), 0, sizeof(T)*N*(x-start));
+            while (x < width && row[x])
+                ++x;
+        }
+    }
+}
+
+template <typename T, int N>
+void BitmapAtlasStorage<T, N>::blitCropped(const msdfgen::BitmapConstRef<T, N> &orig) {
+    msdfgen::BitmapRef<T, N> target(*this);
+    int copyWidth = std::min(width, orig.width);
+    Workload(std::min(height, orig.height)).finish([&target, &orig, copyWidth](int y, int) -> bool {
+        blit(target, orig, 0, y, 0, y, copyWidth, 1);
+        return true;
+    }, threadCount);
+}
+
+template <typename T, int N>
+void BitmapAtlasStorage<T, N>::blitRemapped(const msdfgen::BitmapConstRef<T, N> &orig, const Remap *remapping, int count) {
+    // Remapped targets never overlap, so the subsections can be copied concurrently
+    msdfgen::BitmapRef<T, N> target(*this);
+    Workload(count).finish([&target, &orig, remapping](int i, int) -> bool {
+        const Remap &remap = remapping[i];
+        blit(target, orig, remap.target.x, remap.target.y, remap.source.x, remap.source.y, remap.width, remap.height);
+        return true;
+    }, threadCount);
 }
 
 }
@@ -0,0 +1,24 @@
+
+#include "CancellationToken.h"
+
+namespace msdf_atlas {
+
+CancellationToken::CancellationToken() : cancelled(false) { }
+
+void CancellationToken::cancel() {
+    cancelled.store(true, std::memory_order_relaxed);
+}
+
+void CancellationToken::reset() {
+    cancelled.store(false, std::memory_order_relaxed);
+}
+
+bool CancellationToken::isCancelled() const {
+    return cancelled.load(std::memory_order_relaxed);
+}
+
+bool isCancelled(const CancellationToken *token) {
+    return token && token->isCancelled();
+}
+
+}
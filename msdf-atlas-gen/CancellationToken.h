@@ -0,0 +1,28 @@
+
+#pragma once
+
+#include <atomic>
+
+namespace msdf_atlas {
+
+/// A flag that can be raised from any thread (or a signal handler) to ask long running operations to stop as soon as possible
+class CancellationToken {
+
+public:
+    CancellationToken();
+    /// Requests cancellation
+    void cancel();
+    /// Clears the request so that the token can be reused
+    void reset();
+    /// Returns true if cancellation has been requested
+    bool isCancelled() const;
+
+private:
+    std::atomic<bool> cancelled;
+
+};
+
+/// Returns true if the token is not null and cancellation has been requested
+bool isCancelled(const CancellationToken *token);
+
+}
@@ -1,39 +1,214 @@
 
 #include "Charset.h"
 
+#include <algorithm>
+
 namespace msdf_atlas {
 
 static Charset createAsciiCharset() {
     Charset ascii;
-    for (unicode_t cp = 0x20; cp < 0x7f; ++cp)
-        ascii.add(cp);
+    ascii.addRange(0x20, 0x7e);
     return ascii;
 }
 
 const Charset Charset::ASCII = createAsciiCharset();
 
+Charset::const_iterator::const_iterator() : range(), rangesEnd(), cp() { }
+
+Charset::const_iterator::const_iterator(const Range *range, const Range *rangesEnd) : range(range), rangesEnd(rangesEnd), cp(range < rangesEnd ? range->first : 0) { }
+
+unicode_t Charset::const_iterator::operator*() const {
+    return cp;
+}
+
+Charset::const_iterator &Charset::const_iterator::operator++() {
+    if (cp == range->last) {
+        if (++range < rangesEnd)
+            cp = range->first;
+        else
+            cp = 0;
+    } else
+        ++cp;
+    return *this;
+}
+
+Charset::const_iterator Charset::const_iterator::operator++(int) {
+    const_iterator prev(*this);
+    ++*this;
+    return prev;
+}
+
+bool Charset::const_iterator::operator==(const const_iterator &other) const {
+    return range == other.range && cp == other.cp;
+}
+
+bool Charset::const_iterator::operator!=(const const_iterator &other) const {
+    return !(*this == other);
+}
+
+Charset::Charset() : count(0) { }
+
 void Charset::add(unicode_t cp) {
-    codepoints.insert(cp);
+    addRange(cp, cp);
+}
+
+void Charset::addRange(unicode_t first, unicode_t last) {
+    if (first > last)
+        return;
+    // Find ranges overlapping or adjacent to [first, last] - 64-bit arithmetic avoids overflow at the ends of the codepoint space
+    std::vector<Range>::iterator begin = std::lower_bound(ranges.begin(), ranges.end(), first, [](const Range &range, unicode_t first) -> bool {
+        return (unsigned long long) range.last+1 < first;
+    });
+    std::vector<Range>::iterator end = begin;
+    while (end != ranges.end() && end->first <= (unsigned long long) last+1)
+        ++end;
+    if (begin == end) {
+        ranges.insert(begin, Range { first, last });
+        count += (size_t) (last-first)+1;
+        return;
+    }
+    Range merged = { std::min(first, begin->first), std::max(last, (end-1)->last) };
+    for (std::vector<Range>::iterator it = begin; it != end; ++it)
+        count -= (size_t) (it->last-it->first)+1;
+    count += (size_t) (merged.last-merged.first)+1;
+    *begin = merged;
+    ranges.erase(begin+1, end);
+}
+
+void Charset::add(const unicode_t *codepoints, size_t count) {
+    std::vector<unicode_t> sorted(codepoints, codepoints+count);
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<Range> added;
+    for (unicode_t cp : sorted) {
+        if (!added.empty() && cp <= (unsigned long long) added.back().last+1)
+            added.back().last = std::max(added.back().last, cp);
+        else
+            added.push_back(Range { cp, cp });
+    }
+    Charset addedCharset;
+    addedCharset.assign((std::vector<Range> &&) added);
+    add(addedCharset);
+}
+
+void Charset::add(const Charset &other) {
+    if (other.ranges.empty())
+        return;
+    if (ranges.empty()) {
+        ranges = other.ranges;
+        count = other.count;
+        return;
+    }
+    std::vector<Range> result;
+    result.reserve(ranges.size()+other.ranges.size());
+    std::vector<Range>::const_iterator a = ranges.begin(), b = other.ranges.begin();
+    while (a != ranges.end() || b != other.ranges.end()) {
+        Range next = b == other.ranges.end() || (a != ranges.end() && a->first < b->first) ? *a++ : *b++;
+        if (!result.empty() && next.first <= (unsigned long long) result.back().last+1)
+            result.back().last = std::max(result.back().last, next.last);
+        else
+            result.push_back(next);
+    }
+    assign((std::vector<Range> &&) result);
 }
 
 void Charset::remove(unicode_t cp) {
-    codepoints.erase(cp);
+    removeRange(cp, cp);
+}
+
+void Charset::removeRange(unicode_t first, unicode_t last) {
+    if (first > last)
+        return;
+    std::vector<Range>::iterator begin = std::lower_bound(ranges.begin(), ranges.end(), first, [](const Range &range, unicode_t first) -> bool {
+        return range.last < first;
+    });
+    std::vector<Range>::iterator end = begin;
+    while (end != ranges.end() && end->first <= last)
+        ++end;
+    if (begin == end)
+        return;
+    Range remainders[2];
+    int remainderCount = 0;
+    if (begin->first < first)
+        remainders[remainderCount++] = Range { begin->first, first-1 };
+    if ((end-1)->last > last)
+        remainders[remainderCount++] = Range { last+1, (end-1)->last };
+    for (std::vector<Range>::iterator it = begin; it != end; ++it)
+        count -= (size_t) (it->last-it->first)+1;
+    for (int i = 0; i < remainderCount; ++i)
+        count += (size_t) (remainders[i].last-remainders[i].first)+1;
+    size_t index = begin-ranges.begin();
+    ranges.erase(begin, end);
+    ranges.insert(ranges.begin()+index, remainders, remainders+remainderCount);
+}
+
+void Charset::remove(const Charset &other) {
+    if (ranges.empty() || other.ranges.empty())
+        return;
+    std::vector<Range> result;
+    result.reserve(ranges.size()+other.ranges.size());
+    std::vector<Range>::const_iterator b = other.ranges.begin();
+    for (Range range : ranges) {
+        while (b != other.ranges.end() && b->last < range.first)
+            ++b;
+        for (std::vector<Range>::const_iterator it = b; it != other.ranges.end() && it->first <= range.last; ++it) {
+            if (it->first > range.first)
+                result.push_back(Range { range.first, it->first-1 });
+            if (it->last >= range.last) {
+                range.first = 1, range.last = 0;
+                break;
+            }
+            range.first = it->last+1;
+        }
+        if (range.first <= range.last)
+            result.push_back(range);
+    }
+    assign((std::vector<Range> &&) result);
+}
+
+void Charset::intersect(const Charset &other) {
+    std::vector<Range> result;
+    std::vector<Range>::const_iterator a = ranges.begin(), b = other.ranges.begin();
+    while (a != ranges.end() && b != other.ranges.end()) {
+        unicode_t first = std::max(a->first, b->first);
+        unicode_t last = std::min(a->last, b->last);
+        if (first <= last)
+            result.push_back(Range { first, last });
+        if (a->last < b->last)
+            ++a;
+        else
+            ++b;
+    }
+    assign((std::vector<Range> &&) result);
+}
+
+bool Charset::contains(unicode_t cp) const {
+    std::vector<Range>::const_iterator it = std::lower_bound(ranges.begin(), ranges.end(), cp, [](const Range &range, unicode_t cp) -> bool {
+        return range.last < cp;
+    });
+    return it != ranges.end() && it->first <= cp;
+}
+
+void Charset::assign(std::vector<Range> &&newRanges) {
+    ranges = (std::vector<Range> &&) newRanges;
+    count = 0;
+    for (const Range &range : ranges)
+        count += (size_t) (range.last-range.first)+1;
 }
 
 size_t Charset::size() const {
-    return codepoints.size();
+    return count;
 }
 
 bool Charset::empty() const {
-    return codepoints.empty();
+    return ranges.empty();
 }
 
-std::set<unicode_t>::const_iterator Charset::begin() const {
-    return codepoints.begin();
+Charset::const_iterator Charset::begin() const {
+    return const_iterator(ranges.data(), ranges.data()+ranges.size());
 }
 
-std::set<unicode_t>::const_iterator Charset::end() const {
-    return codepoints.end();
+Charset::const_iterator Charset::end() const {
+    return const_iterator(ranges.data()+ranges.size(), ranges.data()+ranges.size());
 }
 
 }
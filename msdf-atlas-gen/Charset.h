@@ -2,7 +2,9 @@
 #pragma once
 
 #include <cstdlib>
-#include <set>
+#include <cstddef>
+#include <iterator>
+#include <vector>
 #include "types.h"
 
 #ifndef MSDF_ATLAS_PUBLIC
@@ -11,22 +13,68 @@
 
 namespace msdf_atlas {
 
-/// Represents a set of Unicode codepoints (characters)
+/// Represents a set of Unicode codepoints (characters), stored as sorted disjoint ranges.
+/// Dense ranges take a single entry, but there are no bitmap pages, so each isolated codepoint of a sparse set takes its own range
 class Charset {
 
+    struct Range {
+        unicode_t first, last;
+    };
+
 public:
+    /// Iterates over the individual codepoints in ascending order
+    class const_iterator {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef unicode_t value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const unicode_t *pointer;
+        typedef unicode_t reference;
+
+        const_iterator();
+        unicode_t operator*() const;
+        const_iterator &operator++();
+        const_iterator operator++(int);
+        bool operator==(const const_iterator &other) const;
+        bool operator!=(const const_iterator &other) const;
+
+    private:
+        const Range *range, *rangesEnd;
+        unicode_t cp;
+
+        const_iterator(const Range *range, const Range *rangesEnd);
+
+        friend class Charset;
+    };
+
     /// The set of the 95 printable ASCII characters
     static MSDF_ATLAS_PUBLIC const Charset ASCII;
 
-    /// Adds a codepoint
+    Charset();
+
+    /// Adds a codepoint - in linear time of the number of ranges unless it extends or follows the last one
     void add(unicode_t cp);
+    /// Adds many codepoints in any order at once, sorting and merging them with the existing ranges only once
+    void add(const unicode_t *codepoints, size_t count);
+    /// Adds all codepoints between first and last (inclusive)
+    void addRange(unicode_t first, unicode_t last);
+    /// Adds all codepoints of another set (union)
+    void add(const Charset &other);
     /// Removes a codepoint
     void remove(unicode_t cp);
+    /// Removes all codepoints between first and last (inclusive)
+    void removeRange(unicode_t first, unicode_t last);
+    /// Removes all codepoints of another set (difference)
+    void remove(const Charset &other);
+    /// Removes all codepoints not present in another set (intersection)
+    void intersect(const Charset &other);
+    /// Returns true if the set contains the codepoint
+    bool contains(unicode_t cp) const;
 
     size_t size() const;
     bool empty() const;
-    std::set<unicode_t>::const_iterator begin() const;
-    std::set<unicode_t>::const_iterator end() const;
+    const_iterator begin() const;
+    const_iterator end() const;
 
     /// Load character set from a text file with compliant syntax
     bool load(const char *filename, bool disableCharLiterals = false);
@@ -34,7 +82,10 @@ public:
     bool parse(const char *str, size_t strLength, bool disableCharLiterals = false);
 
 private:
-    std::set<unicode_t> codepoints;
+    std::vector<Range> ranges;
+    size_t count;
+
+    void assign(std::vector<Range> &&newRanges);
 
 };
 
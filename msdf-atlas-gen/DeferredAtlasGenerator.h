@@ -0,0 +1,96 @@
+
+#pragma once
+
+#include <vector>
+#include <map>
+#include <queue>
+#include "GlyphBox.h"
+#include "Workload.h"
+#include "AtlasGenerator.h"
+
+namespace msdf_atlas {
+
+/**
+ * An implementation of AtlasGenerator that only queues the submitted glyphs
+ * and generates them later in the order of their priority, within a time budget
+ * of each call to process. This bounds the per-frame cost of bursts of new glyphs.
+ * Until a glyph is ready, its area of the atlas stays empty, or holds a low-resolution preview
+ * if progressive generation is enabled. Nothing runs on its own in the background - queued glyphs
+ * (and the replacement of their previews) are only generated while the caller keeps calling process,
+ * or all at once by processAll.
+ */
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+class DeferredAtlasGenerator {
+
+public:
+    DeferredAtlasGenerator();
+    DeferredAtlasGenerator(int width, int height);
+    template <typename... ARGS>
+    DeferredAtlasGenerator(int width, int height, ARGS... storageArgs);
+    /// Queues the glyphs for generation with the current priority
+    void generate(const GlyphGeometry *glyphs, int count);
+    void rearrange(int width, int height, const Remap *remapping, int count);
+    void resize(int width, int height);
+    /// Generates the queued glyphs with the highest priority for at most the given time (at least one glyph per call),
+    /// outputs the layout indices of glyphs that became ready, and returns the number of glyphs still pending
+    int process(double maxMilliseconds, std::vector<int> *readyGlyphs = nullptr);
+    /// Generates all queued glyphs in the order of their priority with the given number of threads and returns when they are done,
+    /// outputs the layout indices of glyphs that became ready (may be called from the caller's own background thread if the generator is not used meanwhile)
+    void processAll(int threadCount, std::vector<int> *readyGlyphs = nullptr);
+    /// Enables progressive generation - queued glyphs are immediately generated at 1/factor of their resolution
+    /// without error correction and upscaled, until replaced by the full quality version in process (factor <= 1 disables)
+    void setPreviewFactor(int factor);
+    /// Appends the areas of the atlas modified since the last call (by previews and by process) and clears them
+    void collectDirtyRectangles(std::vector<Rectangle> &dirtyRectangles);
+    /// Sets the priority of subsequently queued glyphs, higher priority glyphs are generated first
+    void setPriority(double priority);
+    /// Changes the priority of a pending glyph identified by its index in the layout
+    void prioritize(int layoutIndex, double priority);
+    /// Returns true if the glyph identified by its index in the layout has been generated
+    bool isReady(int layoutIndex) const;
+    /// Returns the number of glyphs waiting to be generated
+    int getPendingCount() const;
+    /// Sets attributes for the generator function
+    void setAttributes(const GeneratorAttributes &attributes);
+    /// Allows access to the underlying AtlasStorage
+    const AtlasStorage &atlasStorage() const;
+    /// Returns the layout of the contained glyphs as a list of GlyphBoxes
+    const std::vector<GlyphBox> &getLayout() const;
+
+private:
+    struct PendingGlyph {
+        GlyphGeometry glyph;
+        double priority;
+    };
+    struct QueueEntry {
+        double priority;
+        unsigned long long sequence;
+        int layoutIndex;
+        /// Lower priority and later submission compare as less
+        bool operator<(const QueueEntry &other) const;
+    };
+
+    AtlasStorage storage;
+    std::vector<GlyphBox> layout;
+    std::map<int, PendingGlyph> pending;
+    std::priority_queue<QueueEntry> queue;
+    unsigned long long sequence;
+    double priority;
+    int previewFactor;
+    std::vector<Rectangle> dirtyRectangles;
+    std::vector<T> glyphBuffer;
+    std::vector<T> previewBuffer;
+    std::vector<T> rotationBuffer;
+    std::vector<byte> errorCorrectionBuffer;
+    GeneratorAttributes attributes;
+
+    void enqueue(int layoutIndex, double priority);
+    void generatePreview(const GlyphGeometry &glyph, const GlyphBox &box);
+    void putGlyphBitmap(const GlyphBox &box, const msdfgen::BitmapConstRef<T, N> &glyphBitmap);
+    void addDirtyRectangle(const GlyphBox &box);
+
+};
+
+}
+
+#include "DeferredAtlasGenerator.hpp"
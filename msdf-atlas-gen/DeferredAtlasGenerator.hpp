@@ -0,0 +1,247 @@
+
+#include "DeferredAtlasGenerator.h"
+
+#include <algorithm>
+#include <chrono>
+#include "bitmap-blit.h"
+
+namespace msdf_atlas {
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+bool DeferredAtlasGenerator<T, N, GEN_FN, AtlasStorage>::QueueEntry::operator<(const QueueEntry &other) const {
+    return priority < other.priority || (priority == other.priority && sequence > other.sequence);
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+DeferredAtlasGenerator<T, N, GEN_FN, AtlasStorage>::DeferredAtlasGenerator() : sequence(0), priority(0), previewFactor(0) { }
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+DeferredAtlasGenerator<T, N, GEN_FN, AtlasStorage>::DeferredAtlasGenerator(int width, int height) : storage(width, height), sequence(0), priority(0), previewFactor(0) { }
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+template <typename... ARGS>
+DeferredAtlasGenerator<T, N, GEN_FN, AtlasStorage>::DeferredAtlasGenerator(int width, int height, ARGS... storageArgs) : storage(width, height, storageArgs...), sequence(0), priority(0), previewFactor(0) { }
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void DeferredAtlasGenerator<T, N, GEN_FN, AtlasStorage>::generate(const GlyphGeometry *glyphs, int count) {
+    for (int i = 0; i < count; ++i) {
+        int layoutIndex = (int) layout.size();
+        layout.push_back((GlyphBox) glyphs[i]);
+        if (!glyphs[i].isWhitespace()) {
+            PendingGlyph &pendingGlyph = pending[layoutIndex];
+            pendingGlyph.glyph = glyphs[i];
+            enqueue(layoutIndex, priority);
+            if (previewFactor > 1)
+                generatePreview(glyphs[i], layout[layoutIndex]);
+        }
+    }
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void DeferredAtlasGenerator<T, N, GEN_FN, AtlasStorage>::rearrange(int width, int height, const Remap *remapping, int count) {
+    // Pending glyphs are placed according to the layout when generated, so moving their empty areas is harmless
+    for (int i = 0; i < count; ++i) {
+        layout[remapping[i].index].rect.x = remapping[i].target.x;
+        layout[remapping[i].index].rect.y = remapping[i].target.y;
+    }
+    AtlasStorage newStorage((AtlasStorage &&) storage, width, height, remapping, count);
+    storage = (AtlasStorage &&) newStorage;
+    // Previously reported positions are no longer valid
+    dirtyRectangles.clear();
+    dirtyRectangles.push_back(Rectangle { 0, 0, width, height });
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void DeferredAtlasGenerator<T, N, GEN_FN, AtlasStorage>::resize(int width, int height) {
+    AtlasStorage newStorage((AtlasStorage &&) storage, width, height);
+    storage = (AtlasStorage &&) newStorage;
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+int DeferredAtlasGenerator<T, N, GEN_FN, AtlasStorage>::process(double maxMilliseconds, std::vector<int> *readyGlyphs) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    bool first = true;
+    while (!queue.empty()) {
+        if (!first && std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now()-start).count() >= maxMilliseconds)
+            break;
+        QueueEntry entry = queue.top();
+        queue.pop();
+        // Skip entries superseded by a later change of priority
+        typename std::map<int, PendingGlyph>::iterator it = pending.find(entry.layoutIndex);
+        if (it == pending.end() || it->second.priority != entry.priority)
+            continue;
+        const GlyphGeometry &glyph = it->second.glyph;
+        const Rectangle &rect = layout[entry.layoutIndex].rect;
+        if (N*rect.w*rect.h > (int) glyphBuffer.size())
+            glyphBuffer.resize(N*rect.w*rect.h);
+        if (rect.w*rect.h > (int) errorCorrectionBuffer.size())
+            errorCorrectionBuffer.resize(rect.w*rect.h);
+        GeneratorAttributes glyphAttributes = attributes;
+        glyphAttributes.config.errorCorrection.buffer = errorCorrectionBuffer.data();
+        msdfgen::BitmapRef<T, N> glyphBitmap(glyphBuffer.data(), rect.w, rect.h);
+        GEN_FN(glyphBitmap, glyph, glyphAttributes);
+        putGlyphBitmap(layout[entry.layoutIndex], glyphBitmap);
+        pending.erase(it);
+        if (readyGlyphs)
+            readyGlyphs->push_back(entry.layoutIndex);
+        first = false;
+    }
+    return (int) pending.size();
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void DeferredAtlasGenerator<T, N, GEN_FN, AtlasStorage>::processAll(int threadCount, std::vector<int> *readyGlyphs) {
+    // Valid queue entries in the order of priority
+    std::vector<int> order;
+    int maxArea = 0;
+    while (!queue.empty()) {
+        QueueEntry entry = queue.top();
+        queue.pop();
+        typename std::map<int, PendingGlyph>::const_iterator it = pending.find(entry.layoutIndex);
+        if (it == pending.end() || it->second.priority != entry.priority)
+            continue;
+        order.push_back(entry.layoutIndex);
+        maxArea = std::max(maxArea, layout[entry.layoutIndex].rect.w*layout[entry.layoutIndex].rect.h);
+    }
+    threadCount = std::max(threadCount, 1);
+    // Each thread has its own glyph and rotation buffer, boxes never overlap so they are put into the storage concurrently
+    std::vector<T> threadBuffers((size_t) threadCount*2*N*maxArea);
+    std::vector<byte> threadErrorCorrectionBuffers((size_t) threadCount*maxArea);
+    Workload((int) order.size()).finish([this, &order, &threadBuffers, &threadErrorCorrectionBuffers, maxArea](int i, int threadNo) -> bool {
+        const GlyphBox &box = layout[order[i]];
+        T *buffer = threadBuffers.data()+(size_t) 2*N*maxArea*threadNo;
+        GeneratorAttributes glyphAttributes = attributes;
+        glyphAttributes.config.errorCorrection.buffer = threadErrorCorrectionBuffers.data()+(size_t) maxArea*threadNo;
+        msdfgen::BitmapRef<T, N> glyphBitmap(buffer, box.rect.w, box.rect.h);
+        GEN_FN(glyphBitmap, pending.find(order[i])->second.glyph, glyphAttributes);
+        if (box.rotated) {
+            msdfgen::BitmapRef<T, N> rotatedBitmap(buffer+(size_t) N*maxArea, box.rect.h, box.rect.w);
+            rotateClockwise(rotatedBitmap, msdfgen::BitmapConstRef<T, N>(glyphBitmap));
+            storage.put(box.rect.x, box.rect.y, msdfgen::BitmapConstRef<T, N>(rotatedBitmap));
+        } else
+            storage.put(box.rect.x, box.rect.y, msdfgen::BitmapConstRef<T, N>(glyphBitmap));
+        return true;
+    }, threadCount);
+    for (int layoutIndex : order) {
+        addDirtyRectangle(layout[layoutIndex]);
+        pending.erase(layoutIndex);
+        if (readyGlyphs)
+            readyGlyphs->push_back(layoutIndex);
+    }
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void DeferredAtlasGenerator<T, N, GEN_FN, AtlasStorage>::setPreviewFactor(int factor) {
+    previewFactor = factor;
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void DeferredAtlasGenerator<T, N, GEN_FN, AtlasStorage>::collectDirtyRectangles(std::vector<Rectangle> &dirtyRectangles) {
+    dirtyRectangles.insert(dirtyRectangles.end(), this->dirtyRectangles.begin(), this->dirtyRectangles.end());
+    this->dirtyRectangles.clear();
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void DeferredAtlasGenerator<T, N, GEN_FN, AtlasStorage>::setPriority(double priority) {
+    this->priority = priority;
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void DeferredAtlasGenerator<T, N, GEN_FN, AtlasStorage>::prioritize(int layoutIndex, double priority) {
+    typename std::map<int, PendingGlyph>::iterator it = pending.find(layoutIndex);
+    if (it != pending.end() && it->second.priority != priority)
+        enqueue(layoutIndex, priority);
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+bool DeferredAtlasGenerator<T, N, GEN_FN, AtlasStorage>::isReady(int layoutIndex) const {
+    return layoutIndex >= 0 && layoutIndex < (int) layout.size() && !pending.count(layoutIndex);
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+int DeferredAtlasGenerator<T, N, GEN_FN, AtlasStorage>::getPendingCount() const {
+    return (int) pending.size();
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void DeferredAtlasGenerator<T, N, GEN_FN, AtlasStorage>::setAttributes(const GeneratorAttributes &attributes) {
+    this->attributes = attributes;
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+const AtlasStorage &DeferredAtlasGenerator<T, N, GEN_FN, AtlasStorage>::atlasStorage() const {
+    return storage;
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+const std::vector<GlyphBox> &DeferredAtlasGenerator<T, N, GEN_FN, AtlasStorage>::getLayout() const {
+    return layout;
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void DeferredAtlasGenerator<T, N, GEN_FN, AtlasStorage>::enqueue(int layoutIndex, double priority) {
+    pending[layoutIndex].priority = priority;
+    QueueEntry entry = { priority, sequence++, layoutIndex };
+    queue.push(entry);
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void DeferredAtlasGenerator<T, N, GEN_FN, AtlasStorage>::generatePreview(const GlyphGeometry &glyph, const GlyphBox &box) {
+    const Rectangle &rect = box.rect;
+    GlyphGeometry previewGlyph(glyph);
+    previewGlyph.downscaleBox(previewFactor);
+    int w, h;
+    previewGlyph.getBoxSize(w, h);
+    if (N*w*h > (int) previewBuffer.size())
+        previewBuffer.resize(N*w*h);
+    if (N*rect.w*rect.h > (int) glyphBuffer.size())
+        glyphBuffer.resize(N*rect.w*rect.h);
+    GeneratorAttributes previewAttributes = attributes;
+    previewAttributes.config.errorCorrection.mode = msdfgen::ErrorCorrectionConfig::DISABLED;
+    previewAttributes.config.errorCorrection.buffer = nullptr;
+    previewAttributes.scanlinePass = false;
+    msdfgen::BitmapRef<T, N> previewBitmap(previewBuffer.data(), w, h);
+    GEN_FN(previewBitmap, previewGlyph, previewAttributes);
+    // Bilinear upscale - the center of full resolution pixel x maps to (x+.5)/factor-.5 in the preview
+    msdfgen::BitmapRef<T, N> glyphBitmap(glyphBuffer.data(), rect.w, rect.h);
+    double invFactor = 1./previewFactor;
+    for (int y = 0; y < rect.h; ++y) {
+        double py = std::max(0., std::min((y+.5)*invFactor-.5, h-1.));
+        int y0 = std::min((int) py, h-2 > 0 ? h-2 : 0), y1 = std::min(y0+1, h-1);
+        double fy = py-y0;
+        for (int x = 0; x < rect.w; ++x) {
+            double px = std::max(0., std::min((x+.5)*invFactor-.5, w-1.));
+            int x0 = std::min((int) px, w-2 > 0 ? w-2 : 0), x1 = std::min(x0+1, w-1);
+            double fx = px-x0;
+            for (int c = 0; c < N; ++c) {
+                double top = (1-fx)*previewBitmap(x0, y1)[c]+fx*previewBitmap(x1, y1)[c];
+                double bottom = (1-fx)*previewBitmap(x0, y0)[c]+fx*previewBitmap(x1, y0)[c];
+                glyphBitmap(x, y)[c] = T((1-fy)*bottom+fy*top);
+            }
+        }
+    }
+    putGlyphBitmap(box, glyphBitmap);
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void DeferredAtlasGenerator<T, N, GEN_FN, AtlasStorage>::putGlyphBitmap(const GlyphBox &box, const msdfgen::BitmapConstRef<T, N> &glyphBitmap) {
+    if (box.rotated) {
+        if (N*box.rect.w*box.rect.h > (int) rotationBuffer.size())
+            rotationBuffer.resize(N*box.rect.w*box.rect.h);
+        msdfgen::BitmapRef<T, N> rotatedBitmap(rotationBuffer.data(), box.rect.h, box.rect.w);
+        rotateClockwise(rotatedBitmap, glyphBitmap);
+        storage.put(box.rect.x, box.rect.y, msdfgen::BitmapConstRef<T, N>(rotatedBitmap));
+    } else
+        storage.put(box.rect.x, box.rect.y, glyphBitmap);
+    addDirtyRectangle(box);
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void DeferredAtlasGenerator<T, N, GEN_FN, AtlasStorage>::addDirtyRectangle(const GlyphBox &box) {
+    if (box.rotated)
+        dirtyRectangles.push_back(Rectangle { box.rect.x, box.rect.y, box.rect.h, box.rect.w });
+    else
+        dirtyRectangles.push_back(box.rect);
+}
+
+}
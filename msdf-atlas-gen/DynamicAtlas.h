@@ -2,6 +2,8 @@
 #pragma once
 
 #include <vector>
+#include <mutex>
+#include <condition_variable>
 #include "RectanglePacker.h"
 #include "AtlasGenerator.h"
 
@@ -29,8 +31,13 @@ public:
     explicit DynamicAtlas(int minSide, ARGS... args);
     /// Creates with a configured generator. The generator must not contain any prior glyphs!
     explicit DynamicAtlas(AtlasGenerator &&generator);
+    /// Creates with a configured generator that already contains the glyphs, placed in an atlas of the given dimensions (e.g. a prebuilt static atlas)
+    DynamicAtlas(AtlasGenerator &&generator, int width, int height, const GlyphGeometry *glyphs, int count);
     /// Adds a batch of glyphs. Adding more than one glyph at a time may improve packing efficiency
     ChangeFlags add(GlyphGeometry *glyphs, int count, bool allowRearrange = false);
+    /// Adds a batch of glyphs, may be called from multiple threads at once. Packing is serialized, but the glyphs are generated
+    /// in the calling thread in parallel with other calls. Requires the generator's reserve and render functions
+    ChangeFlags addConcurrently(GlyphGeometry *glyphs, int count, bool allowRearrange = false);
     /// Allows access to generator. Do not add glyphs to the generator directly!
     AtlasGenerator &atlasGenerator();
     const AtlasGenerator &atlasGenerator() const;
@@ -44,6 +51,18 @@ private:
     AtlasGenerator generator;
     std::vector<Rectangle> rectangles;
     std::vector<Remap> remapBuffer;
+    /// Synchronization of concurrent insertion - resizing or rearranging the atlas waits until all reserved glyphs are rendered
+    struct Synchronization {
+        std::mutex mutex;
+        std::condition_variable condition;
+        int pendingBatches;
+        bool exclusive;
+        inline Synchronization() : pendingBatches(0), exclusive(false) { }
+        inline Synchronization(const Synchronization &) : Synchronization() { }
+        inline Synchronization &operator=(const Synchronization &) { return *this; }
+    } sync;
+
+    ChangeFlags layoutGlyphs(GlyphGeometry *glyphs, int count, bool allowRearrange, std::unique_lock<std::mutex> *lock);
 
 };
 
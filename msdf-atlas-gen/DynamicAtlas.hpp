@@ -1,6 +1,7 @@
 
 #include "DynamicAtlas.h"
 
+#include <algorithm>
 #include "utils.hpp"
 
 namespace msdf_atlas {
@@ -15,8 +16,68 @@ DynamicAtlas<AtlasGenerator>::DynamicAtlas(int minSide, ARGS... args) : side(min
 template <class AtlasGenerator>
 DynamicAtlas<AtlasGenerator>::DynamicAtlas(AtlasGenerator &&generator) : side(0), spacing(0), glyphCount(0), totalArea(0), generator((AtlasGenerator &&) generator) { }
 
+template <class AtlasGenerator>
+DynamicAtlas<AtlasGenerator>::DynamicAtlas(AtlasGenerator &&generator, int width, int height, const GlyphGeometry *glyphs, int count) : side(std::max(width, height)), spacing(0), glyphCount(count), totalArea(0), generator((AtlasGenerator &&) generator) {
+    for (int i = 0; i < count; ++i) {
+        if (!glyphs[i].isWhitespace()) {
+            Rectangle rect = glyphs[i].getBoxRect();
+            // A rotated glyph occupies its box with the dimensions swapped
+            if (glyphs[i].isBoxRotated())
+                std::swap(rect.w, rect.h);
+            rect.w += spacing, rect.h += spacing;
+            rectangles.push_back(rect);
+            Remap remapEntry = { };
+            remapEntry.index = i;
+            remapEntry.target.x = rect.x;
+            remapEntry.target.y = rect.y;
+            remapEntry.width = rect.w-spacing;
+            remapEntry.height = rect.h-spacing;
+            remapBuffer.push_back(remapEntry);
+            totalArea += rect.w*rect.h;
+        }
+    }
+    // The remaining free space of the atlas is reconstructed around the existing glyphs
+    packer = RectanglePacker(side+spacing, side+spacing, rectangles.data(), rectangles.size());
+    if (width != height)
+        this->generator.resize(side, side);
+}
+
 template <class AtlasGenerator>
 typename DynamicAtlas<AtlasGenerator>::ChangeFlags DynamicAtlas<AtlasGenerator>::add(GlyphGeometry *glyphs, int count, bool allowRearrange) {
+    ChangeFlags changeFlags = layoutGlyphs(glyphs, count, allowRearrange, nullptr);
+    generator.generate(glyphs, count);
+    glyphCount += count;
+    return changeFlags;
+}
+
+template <class AtlasGenerator>
+typename DynamicAtlas<AtlasGenerator>::ChangeFlags DynamicAtlas<AtlasGenerator>::addConcurrently(GlyphGeometry *glyphs, int count, bool allowRearrange) {
+    ChangeFlags changeFlags;
+    {
+        std::unique_lock<std::mutex> lock(sync.mutex);
+        sync.condition.wait(lock, [this]() -> bool {
+            return !sync.exclusive;
+        });
+        changeFlags = layoutGlyphs(glyphs, count, allowRearrange, &lock);
+        generator.reserve(glyphs, count);
+        glyphCount += count;
+        ++sync.pendingBatches;
+        if (sync.exclusive) {
+            sync.exclusive = false;
+            sync.condition.notify_all();
+        }
+    }
+    generator.render(glyphs, count);
+    {
+        std::lock_guard<std::mutex> lock(sync.mutex);
+        --sync.pendingBatches;
+    }
+    sync.condition.notify_all();
+    return changeFlags;
+}
+
+template <class AtlasGenerator>
+typename DynamicAtlas<AtlasGenerator>::ChangeFlags DynamicAtlas<AtlasGenerator>::layoutGlyphs(GlyphGeometry *glyphs, int count, bool allowRearrange, std::unique_lock<std::mutex> *lock) {
     ChangeFlags changeFlags = 0;
     int start = rectangles.size();
     for (int i = 0; i < count; ++i) {
@@ -49,6 +110,13 @@ typename DynamicAtlas<AtlasGenerator>::ChangeFlags DynamicAtlas<AtlasGenerator>:
             }
             changeFlags |= RESIZED;
         }
+        if (lock && changeFlags) {
+            // Pixels of glyphs still being rendered by other threads must not be moved - block new insertions and wait for them
+            sync.exclusive = true;
+            sync.condition.wait(*lock, [this]() -> bool {
+                return !sync.pendingBatches;
+            });
+        }
         if (packerStart < start) {
             for (int i = packerStart; i < start; ++i) {
                 Remap &remap = remapBuffer[i];
@@ -66,8 +134,6 @@ typename DynamicAtlas<AtlasGenerator>::ChangeFlags DynamicAtlas<AtlasGenerator>:
             glyphs[remapBuffer[i].index-glyphCount].placeBox(rectangles[i].x, rectangles[i].y);
         }
     }
-    generator.generate(glyphs, count);
-    glyphCount += count;
     return changeFlags;
 }
 
@@ -145,6 +145,24 @@ bool FontGeometry::addGlyph(GlyphGeometry &&glyph) {
     return true;
 }
 
+bool FontGeometry::moveGlyphs(std::vector<GlyphGeometry> *glyphStorage) {
+    if (!(glyphStorage && glyphs == &ownGlyphs && glyphStorage != &ownGlyphs))
+        return false;
+    size_t offset = glyphStorage->size()-rangeStart;
+    glyphStorage->reserve(glyphStorage->size()+(rangeEnd-rangeStart));
+    for (size_t i = rangeStart; i < rangeEnd; ++i)
+        glyphStorage->push_back((GlyphGeometry &&) ownGlyphs[i]);
+    for (std::map<int, size_t>::iterator it = glyphsByIndex.begin(); it != glyphsByIndex.end(); ++it)
+        it->second += offset;
+    for (std::map<unicode_t, size_t>::iterator it = glyphsByCodepoint.begin(); it != glyphsByCodepoint.end(); ++it)
+        it->second += offset;
+    ownGlyphs.clear();
+    glyphs = glyphStorage;
+    rangeStart += offset;
+    rangeEnd += offset;
+    return true;
+}
+
 int FontGeometry::loadKerning(msdfgen::FontHandle *font) {
     int loaded = 0;
     for (size_t i = rangeStart; i < rangeEnd; ++i)
@@ -47,6 +47,8 @@ public:
     /// Adds a loaded glyph
     bool addGlyph(const GlyphGeometry &glyph);
     bool addGlyph(GlyphGeometry &&glyph);
+    /// Moves glyphs loaded into the font's own storage to the end of an external glyph storage, e.g. after loading fonts in parallel
+    bool moveGlyphs(std::vector<GlyphGeometry> *glyphStorage);
     /// Loads kerning pairs for all glyphs that are currently present, returns the number of loaded kerning pairs
     int loadKerning(msdfgen::FontHandle *font);
     /// Sets a name to be associated with the font
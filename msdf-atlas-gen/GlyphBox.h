@@ -13,6 +13,8 @@ struct GlyphBox {
         double l, b, r, t;
     } bounds;
     Rectangle rect;
+    /// The glyph is rotated 90 degrees clockwise in the atlas (rect dimensions are not swapped)
+    bool rotated;
 
 };
 
@@ -2,6 +2,7 @@
 #include "GlyphGeometry.h"
 
 #include <cmath>
+#include <algorithm>
 #include <core/ShapeDistanceFinder.h>
 
 namespace msdf_atlas {
@@ -57,6 +58,7 @@ void GlyphGeometry::wrapBox(const GlyphAttributes &glyphAttributes) {
     Padding fullPadding = (glyphAttributes.innerPadding+glyphAttributes.outerPadding)/geometryScale;
     box.range = range;
     box.scale = scale;
+    box.rotated = false;
     if (bounds.l < bounds.r && bounds.b < bounds.t) {
         double l = bounds.l, b = bounds.b, r = bounds.r, t = bounds.t;
         l += range.lower, b += range.lower;
@@ -118,6 +120,7 @@ void GlyphGeometry::frameBox(const GlyphAttributes &glyphAttributes, int width,
     Padding fullPadding = (glyphAttributes.innerPadding+glyphAttributes.outerPadding)/geometryScale;
     box.range = range;
     box.scale = scale;
+    box.rotated = false;
     box.rect.w = width;
     box.rect.h = height;
     if (fixedX && fixedY) {
@@ -183,6 +186,44 @@ void GlyphGeometry::setBoxRect(const Rectangle &rect) {
     box.rect = rect;
 }
 
+void GlyphGeometry::setBoxPage(int page) {
+    box.page = page;
+}
+
+void GlyphGeometry::setBoxRotation(bool rotated) {
+    box.rotated = rotated;
+}
+
+void GlyphGeometry::downscaleBox(int factor) {
+    if (factor > 1) {
+        box.rect.w = (box.rect.w+factor-1)/factor;
+        box.rect.h = (box.rect.h+factor-1)/factor;
+        box.scale /= factor;
+    }
+}
+
+bool GlyphGeometry::placeBoxAtQuadAtlasBounds(double l, double b, double r, double t, bool rotated) {
+    if (!(box.rect.w > 0 && box.rect.h > 0))
+        return !(l || b || r || t);
+    if (rotated) {
+        double x = l-box.outerPadding.b-.5, y = b-box.outerPadding.r-.5;
+        double w = r+box.outerPadding.t+.5-x, h = t+box.outerPadding.l+.5-y;
+        if (fabs(w-box.rect.h) > .5 || fabs(h-box.rect.w) > .5)
+            return false;
+        box.rect.x = (int) floor(x+.5);
+        box.rect.y = (int) floor(y+.5);
+    } else {
+        double x = l-box.outerPadding.l-.5, y = b-box.outerPadding.b-.5;
+        double w = r+box.outerPadding.r+.5-x, h = t+box.outerPadding.t+.5-y;
+        if (fabs(w-box.rect.w) > .5 || fabs(h-box.rect.h) > .5)
+            return false;
+        box.rect.x = (int) floor(x+.5);
+        box.rect.y = (int) floor(y+.5);
+    }
+    box.rotated = rotated;
+    return true;
+}
+
 int GlyphGeometry::getIndex() const {
     return index;
 }
@@ -234,6 +275,21 @@ void GlyphGeometry::getBoxSize(int &w, int &h) const {
     w = box.rect.w, h = box.rect.h;
 }
 
+int GlyphGeometry::getBoxPage() const {
+    return box.page;
+}
+
+bool GlyphGeometry::isBoxRotated() const {
+    return box.rotated;
+}
+
+bool GlyphGeometry::isBoxInRegion(const Rectangle &region) const {
+    Rectangle rect = box.rect;
+    if (box.rotated)
+        std::swap(rect.w, rect.h);
+    return rect.w > 0 && rect.h > 0 && rect.x >= region.x && rect.y >= region.y && rect.x+rect.w <= region.x+region.w && rect.y+rect.h <= region.y+region.h;
+}
+
 msdfgen::Range GlyphGeometry::getBoxRange() const {
     return box.range;
 }
@@ -262,7 +318,12 @@ void GlyphGeometry::getQuadPlaneBounds(double &l, double &b, double &r, double &
 }
 
 void GlyphGeometry::getQuadAtlasBounds(double &l, double &b, double &r, double &t) const {
-    if (box.rect.w > 0 && box.rect.h > 0) {
+    if (box.rect.w > 0 && box.rect.h > 0 && box.rotated) {
+        l = box.rect.x+box.outerPadding.b+.5;
+        b = box.rect.y+box.outerPadding.r+.5;
+        r = box.rect.x-box.outerPadding.t+box.rect.h-.5;
+        t = box.rect.y-box.outerPadding.l+box.rect.w-.5;
+    } else if (box.rect.w > 0 && box.rect.h > 0) {
         l = box.rect.x+box.outerPadding.l+.5;
         b = box.rect.y+box.outerPadding.b+.5;
         r = box.rect.x-box.outerPadding.r+box.rect.w-.5;
@@ -281,6 +342,7 @@ GlyphGeometry::operator GlyphBox() const {
     box.advance = advance;
     getQuadPlaneBounds(box.bounds.l, box.bounds.b, box.bounds.r, box.bounds.t);
     box.rect.x = this->box.rect.x, box.rect.y = this->box.rect.y, box.rect.w = this->box.rect.w, box.rect.h = this->box.rect.h;
+    box.rotated = this->box.rotated;
     return box;
 }
 
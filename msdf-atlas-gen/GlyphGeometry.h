@@ -40,6 +40,14 @@ public:
     void placeBox(int x, int y);
     /// Sets the glyph's box's rectangle in the atlas
     void setBoxRect(const Rectangle &rect);
+    /// Sets the index of the atlas page that holds the glyph's box
+    void setBoxPage(int page);
+    /// Sets whether the glyph's box is rotated 90 degrees clockwise in the atlas, so that it occupies its height horizontally and its width vertically
+    void setBoxRotation(bool rotated);
+    /// Reduces the resolution of the glyph's box by an integer factor while covering the same area, for low-resolution previews
+    void downscaleBox(int factor);
+    /// Positions the glyph's box so that its quad atlas bounds match the given ones, returns false if the box's dimensions do not match
+    bool placeBoxAtQuadAtlasBounds(double l, double b, double r, double t, bool rotated = false);
     /// Returns the glyph's index within the font
     int getIndex() const;
     /// Returns the glyph's index as a msdfgen::GlyphIndex
@@ -56,12 +64,18 @@ public:
     const msdfgen::Shape::Bounds &getShapeBounds() const;
     /// Returns the glyph's advance
     double getAdvance() const;
-    /// Returns the glyph's box in the atlas
+    /// Returns the glyph's box in the atlas (the dimensions are not swapped if rotated)
     Rectangle getBoxRect() const;
     /// Outputs the position and dimensions of the glyph's box in the atlas
     void getBoxRect(int &x, int &y, int &w, int &h) const;
     /// Outputs the dimensions of the glyph's box in the atlas
     void getBoxSize(int &w, int &h) const;
+    /// Returns the index of the atlas page that holds the glyph's box
+    int getBoxPage() const;
+    /// Returns true if the glyph's box is rotated 90 degrees clockwise in the atlas
+    bool isBoxRotated() const;
+    /// Returns true if the glyph's box is non-empty and lies entirely within the region of the atlas
+    bool isBoxInRegion(const Rectangle &region) const;
     /// Returns the range needed to generate the glyph's SDF
     msdfgen::Range getBoxRange() const;
     /// Returns the projection needed to generate the glyph's bitmap
@@ -72,7 +86,7 @@ public:
     msdfgen::Vector2 getBoxTranslate() const;
     /// Outputs the bounding box of the glyph as it should be placed on the baseline
     void getQuadPlaneBounds(double &l, double &b, double &r, double &t) const;
-    /// Outputs the bounding box of the glyph in the atlas
+    /// Outputs the bounding box of the glyph in the atlas - if rotated, its plane left, bottom, right, top correspond to atlas top, left, bottom, right
     void getQuadAtlasBounds(double &l, double &b, double &r, double &t) const;
     /// Returns true if the glyph is a whitespace and has no geometry
     bool isWhitespace() const;
@@ -92,6 +106,8 @@ private:
         double scale;
         msdfgen::Vector2 translate;
         Padding outerPadding;
+        int page;
+        bool rotated;
     } box;
 
 };
@@ -1,11 +1,16 @@
 
 #include "GridAtlasPacker.h"
 
+#include <vector>
 #include <algorithm>
+#include "Workload.h"
 #include "utils.hpp"
+#include "scale-search.hpp"
 
 namespace msdf_atlas {
 
+#define MIN_GLYPHS_PER_THREAD 64
+
 static bool squareConstraint(DimensionsConstraint constraint) {
     switch (constraint) {
         case DimensionsConstraint::SQUARE:
@@ -15,6 +20,7 @@ static bool squareConstraint(DimensionsConstraint constraint) {
             return true;
         case DimensionsConstraint::NONE:
         case DimensionsConstraint::POWER_OF_TWO_RECTANGLE:
+        case DimensionsConstraint::MINIMUM_MEMORY:
             return false;
     }
     return true;
@@ -26,6 +32,7 @@ void GridAtlasPacker::lowerToConstraint(int &width, int &height, DimensionsConst
     switch (constraint) {
         case DimensionsConstraint::NONE:
         case DimensionsConstraint::SQUARE:
+        case DimensionsConstraint::MINIMUM_MEMORY:
             break;
         case DimensionsConstraint::EVEN_SQUARE:
             width &= ~1;
@@ -51,6 +58,7 @@ void GridAtlasPacker::raiseToConstraint(int &width, int &height, DimensionsConst
     switch (constraint) {
         case DimensionsConstraint::NONE:
         case DimensionsConstraint::SQUARE:
+        case DimensionsConstraint::MINIMUM_MEMORY:
             break;
         case DimensionsConstraint::EVEN_SQUARE:
             width += width&1;
@@ -89,35 +97,73 @@ GridAtlasPacker::GridAtlasPacker() :
     pxRange(0),
     miterLimit(0),
     pxAlignOriginX(false), pxAlignOriginY(false),
+    scaleHint(0),
     scaleMaximizationTolerance(.001),
     alignedColumnsBias(.125),
-    cutoff(false)
+    cutoff(false),
+    variableCellWidths(false),
+    uniformWidth(-1), uniformHeight(-1),
+    fitAttempts(0),
+    threadCount(1),
+    cancellationToken(nullptr)
 { }
 
+/// Partial result of the bounds reduction over a subset of glyphs
+struct GlyphBoundsAccumulator {
+    msdfgen::Shape::Bounds bounds;
+    double maxWidth, maxHeight;
+};
+
+static void accumulateGlyphBounds(GlyphBoundsAccumulator &acc, const GlyphGeometry &glyph, double scale, double outerRange, double miterLimit) {
+    if (glyph.isWhitespace())
+        return;
+    double geometryScale = glyph.getGeometryScale();
+    double shapeOuterRange = outerRange/geometryScale;
+    geometryScale *= scale;
+    const msdfgen::Shape::Bounds &shapeBounds = glyph.getShapeBounds();
+    double l = shapeBounds.l, b = shapeBounds.b, r = shapeBounds.r, t = shapeBounds.t;
+    l -= shapeOuterRange, b -= shapeOuterRange;
+    r += shapeOuterRange, t += shapeOuterRange;
+    if (miterLimit > 0)
+        glyph.getShape().boundMiters(l, b, r, t, shapeOuterRange, miterLimit, 1);
+    l *= geometryScale, b *= geometryScale;
+    r *= geometryScale, t *= geometryScale;
+    acc.bounds.l = std::min(acc.bounds.l, l);
+    acc.bounds.b = std::min(acc.bounds.b, b);
+    acc.bounds.r = std::max(acc.bounds.r, r);
+    acc.bounds.t = std::max(acc.bounds.t, t);
+    acc.maxWidth = std::max(acc.maxWidth, r-l);
+    acc.maxHeight = std::max(acc.maxHeight, t-b);
+}
+
 msdfgen::Shape::Bounds GridAtlasPacker::getMaxBounds(double &maxWidth, double &maxHeight, GlyphGeometry *glyphs, int count, double scale, double outerRange) const {
     static const double LARGE_VALUE = 1e240;
-    msdfgen::Shape::Bounds maxBounds = { +LARGE_VALUE, +LARGE_VALUE, -LARGE_VALUE, -LARGE_VALUE };
-    for (GlyphGeometry *glyph = glyphs, *end = glyphs+count; glyph < end; ++glyph) {
-        if (!glyph->isWhitespace()) {
-            double geometryScale = glyph->getGeometryScale();
-            double shapeOuterRange = outerRange/geometryScale;
-            geometryScale *= scale;
-            const msdfgen::Shape::Bounds &shapeBounds = glyph->getShapeBounds();
-            double l = shapeBounds.l, b = shapeBounds.b, r = shapeBounds.r, t = shapeBounds.t;
-            l -= shapeOuterRange, b -= shapeOuterRange;
-            r += shapeOuterRange, t += shapeOuterRange;
-            if (miterLimit > 0)
-                glyph->getShape().boundMiters(l, b, r, t, shapeOuterRange, miterLimit, 1);
-            l *= geometryScale, b *= geometryScale;
-            r *= geometryScale, t *= geometryScale;
-            maxBounds.l = std::min(maxBounds.l, l);
-            maxBounds.b = std::min(maxBounds.b, b);
-            maxBounds.r = std::max(maxBounds.r, r);
-            maxBounds.t = std::max(maxBounds.t, t);
-            maxWidth = std::max(maxWidth, r-l);
-            maxHeight = std::max(maxHeight, t-b);
+    GlyphBoundsAccumulator total = { { +LARGE_VALUE, +LARGE_VALUE, -LARGE_VALUE, -LARGE_VALUE }, maxWidth, maxHeight };
+    int reductionThreads = std::min(threadCount, count/MIN_GLYPHS_PER_THREAD);
+    if (reductionThreads > 1) {
+        // Min / max is exact and order-independent, so combining per-thread partial results matches the serial loop
+        std::vector<GlyphBoundsAccumulator> partials(reductionThreads, total);
+        GlyphBoundsAccumulator *partialData = partials.data();
+        double miterLimit = this->miterLimit;
+        Workload(count).finish([partialData, glyphs, scale, outerRange, miterLimit](int i, int threadNo) -> bool {
+            accumulateGlyphBounds(partialData[threadNo], glyphs[i], scale, outerRange, miterLimit);
+            return true;
+        }, reductionThreads);
+        for (const GlyphBoundsAccumulator &partial : partials) {
+            total.bounds.l = std::min(total.bounds.l, partial.bounds.l);
+            total.bounds.b = std::min(total.bounds.b, partial.bounds.b);
+            total.bounds.r = std::max(total.bounds.r, partial.bounds.r);
+            total.bounds.t = std::max(total.bounds.t, partial.bounds.t);
+            total.maxWidth = std::max(total.maxWidth, partial.maxWidth);
+            total.maxHeight = std::max(total.maxHeight, partial.maxHeight);
         }
+    } else {
+        for (int i = 0; i < count; ++i)
+            accumulateGlyphBounds(total, glyphs[i], scale, outerRange, miterLimit);
     }
+    msdfgen::Shape::Bounds maxBounds = total.bounds;
+    maxWidth = total.maxWidth;
+    maxHeight = total.maxHeight;
     if (maxBounds.l >= maxBounds.r || maxBounds.b >= maxBounds.t)
         maxBounds = msdfgen::Shape::Bounds();
     Padding fullPadding = scale*(innerUnitPadding+outerUnitPadding)+innerPxPadding+outerPxPadding;
@@ -136,7 +182,7 @@ msdfgen::Shape::Bounds GridAtlasPacker::getMaxBounds(double &maxWidth, double &m
     return maxBounds;
 }
 
-double GridAtlasPacker::scaleToFit(GlyphGeometry *glyphs, int count, int cellWidth, int cellHeight, msdfgen::Shape::Bounds &maxBounds, double &maxWidth, double &maxHeight) const {
+double GridAtlasPacker::scaleToFit(GlyphGeometry *glyphs, int count, int cellWidth, int cellHeight, msdfgen::Shape::Bounds &maxBounds, double &maxWidth, double &maxHeight) {
     static const int BIG_VALUE = 1<<28;
     if (cellWidth <= 0)
         cellWidth = BIG_VALUE;
@@ -144,33 +190,139 @@ double GridAtlasPacker::scaleToFit(GlyphGeometry *glyphs, int count, int cellWid
         cellHeight = BIG_VALUE;
     --cellWidth, --cellHeight; // Implicit half-pixel padding from each side to make sure that no representable values are beyond outermost pixel centers
     cellWidth -= spacing, cellHeight -= spacing;
-    bool lastResult = false;
-    #define TRY_FIT(scale) (maxWidth = 0, maxHeight = 0, maxBounds = getMaxBounds(maxWidth, maxHeight, glyphs, count, (scale), -(unitRange.lower+pxRange.lower/(scale))), lastResult = maxWidth <= cellWidth && maxHeight <= cellHeight)
-    double minScale = 1, maxScale = 1;
-    if (TRY_FIT(1)) {
-        while (maxScale < 1e+32 && ((maxScale = 2*minScale), TRY_FIT(maxScale)))
-            minScale = maxScale;
-    } else {
-        while (minScale > 1e-32 && ((minScale = .5*maxScale), !TRY_FIT(minScale)))
-            maxScale = minScale;
-    }
-    if (minScale == maxScale)
-        return 0;
-    while (minScale/maxScale < 1-scaleMaximizationTolerance) {
-        double midScale = .5*(minScale+maxScale);
-        if (TRY_FIT(midScale))
-            minScale = midScale;
-        else
-            maxScale = midScale;
+    #define TRY_FIT(scale) (++fitAttempts, maxWidth = 0, maxHeight = 0, maxBounds = getMaxBounds(maxWidth, maxHeight, glyphs, count, (scale), -(unitRange.lower+pxRange.lower/(scale))), maxWidth <= cellWidth && maxHeight <= cellHeight)
+    // The largest glyph dimensions are approximately linear in scale, so two evaluations locate the scale at which they fill the cell,
+    // and the search starts from there (or from the hint) with a small step
+    double seed = 1, initialRatio = 2;
+    if (scaleHint > 0)
+        seed = scaleHint, initialRatio = 1+4*scaleMaximizationTolerance;
+    else {
+        TRY_FIT(1);
+        double width1 = maxWidth, height1 = maxHeight;
+        TRY_FIT(2);
+        double estimate = 1e+32;
+        if (maxWidth > width1)
+            estimate = std::min(estimate, 1+(cellWidth-width1)/(maxWidth-width1));
+        if (maxHeight > height1)
+            estimate = std::min(estimate, 1+(cellHeight-height1)/(maxHeight-height1));
+        if (estimate > 0 && estimate < 1e+32)
+            seed = estimate, initialRatio = 1+4*scaleMaximizationTolerance;
     }
-    if (!lastResult)
-        TRY_FIT(minScale);
-    return minScale;
+    return maximizeScale([this, glyphs, count, cellWidth, cellHeight, &maxBounds, &maxWidth, &maxHeight](double scale) -> bool {
+        return TRY_FIT(scale);
+    }, seed, initialRatio, scaleMaximizationTolerance, cancellationToken);
+}
+
+GlyphGeometry::GlyphAttributes GridAtlasPacker::glyphAttributes() const {
+    GlyphGeometry::GlyphAttributes attribs = { };
+    attribs.scale = scale;
+    attribs.range = unitRange+pxRange/scale;
+    attribs.innerPadding = innerUnitPadding+1/scale*innerPxPadding;
+    attribs.outerPadding = outerUnitPadding+1/scale*outerPxPadding;
+    attribs.miterLimit = miterLimit;
+    attribs.pxAlignOriginX = pxAlignOriginX;
+    attribs.pxAlignOriginY = pxAlignOriginY;
+    return attribs;
 }
 
-// Can this spaghetti code be simplified?
-// Idea: Maybe it could be rewritten into a while (not all properties deduced) cycle, and compute one value in each iteration
 int GridAtlasPacker::pack(GlyphGeometry *glyphs, int count) {
+    fitAttempts = 0;
+    rowLengths.clear();
+    rowCellWidths.clear();
+    bool fixedWidth = width > 0 || columns > 0;
+    bool fixedHeight = height > 0;
+    // An explicit column count also limits the number of cells in each row
+    int maxRowLength = columns > 0 ? columns : 0;
+    int result = packGrid(glyphs, count);
+    if (result < 0 || !count || !variableCellWidths || hFixed)
+        return result;
+    uniformWidth = width, uniformHeight = height;
+    return packVariableWidths(glyphs, count, fixedWidth, fixedHeight, maxRowLength);
+}
+
+int GridAtlasPacker::layoutRows(const std::vector<int> &glyphCellWidths, int width, int maxRowLength) {
+    rowLengths.clear();
+    rowCellWidths.clear();
+    int rowLength = 0, rowCellWidth = 0;
+    for (int glyphCellWidth : glyphCellWidths) {
+        int newCellWidth = std::max(rowCellWidth, glyphCellWidth);
+        if (rowLength > 0 && ((rowLength+1)*newCellWidth > width+spacing || rowLength == maxRowLength)) {
+            rowLengths.push_back(rowLength);
+            rowCellWidths.push_back(rowCellWidth);
+            rowLength = 0;
+            newCellWidth = glyphCellWidth;
+        }
+        ++rowLength;
+        rowCellWidth = newCellWidth;
+    }
+    if (rowLength > 0) {
+        rowLengths.push_back(rowLength);
+        rowCellWidths.push_back(rowCellWidth);
+    }
+    return (int) rowLengths.size();
+}
+
+int GridAtlasPacker::packVariableWidths(GlyphGeometry *glyphs, int count, bool fixedWidth, bool fixedHeight, int maxRowLength) {
+    // Each row's cells are as wide as its widest glyph, so a cell is still addressed by its row and position within the row
+    GlyphGeometry::GlyphAttributes attribs = glyphAttributes();
+    std::vector<int> glyphCellWidths;
+    for (GlyphGeometry *glyph = glyphs, *end = glyphs+count; glyph < end; ++glyph) {
+        if (!glyph->isWhitespace()) {
+            glyph->wrapBox(attribs);
+            glyphCellWidths.push_back(std::min(glyph->getBoxRect().w+spacing, cellWidth));
+        }
+    }
+
+    if (!fixedWidth) {
+        double bestRating = -1;
+        int bestWidth = width, bestHeight = height;
+        for (int q = 1, maxColumns = 2*(int) sqrt((double) glyphCellWidths.size())+2; q <= maxColumns && !isCancelled(cancellationToken); ++q) {
+            int curWidth = q*cellWidth;
+            int curHeight = layoutRows(glyphCellWidths, curWidth, maxRowLength)*cellHeight;
+            raiseToConstraint(curWidth, curHeight, dimensionsConstraint);
+            double rating = dimensionsRating(curWidth, curHeight, false);
+            if (rating < bestRating || bestRating < 0) {
+                bestRating = rating;
+                bestWidth = curWidth, bestHeight = curHeight;
+            }
+        }
+        width = bestWidth, height = bestHeight;
+    }
+    if (isCancelled(cancellationToken))
+        return -1;
+    // Rows only get shorter as the width grows, so the laid out rows always fit the chosen height
+    rows = layoutRows(glyphCellWidths, width, maxRowLength);
+    if (fixedWidth && !fixedHeight) {
+        height = rows*cellHeight;
+        raiseToConstraint(width, height, dimensionsConstraint);
+    }
+    if (rows*cellHeight > height) {
+        rows = height/cellHeight;
+        rowLengths.resize(rows);
+        rowCellWidths.resize(rows);
+    }
+    columns = 0;
+    for (int rowLength : rowLengths)
+        columns = std::max(columns, rowLength);
+
+    int col = 0, row = 0;
+    for (GlyphGeometry *glyph = glyphs, *end = glyphs+count; glyph < end; ++glyph) {
+        if (!glyph->isWhitespace()) {
+            if (row >= rows)
+                return end-glyph;
+            glyph->frameBox(attribs, rowCellWidths[row]-spacing, cellHeight-spacing, nullptr, vFixed ? &fixedY : nullptr);
+            glyph->placeBox(col*rowCellWidths[row], height-(row+1)*cellHeight);
+            if (++col >= rowLengths[row]) {
+                ++row;
+                col = 0;
+            }
+        }
+    }
+
+    return 0;
+}
+
+int GridAtlasPacker::packGrid(GlyphGeometry *glyphs, int count) {
     if (!count)
         return 0;
     GridAtlasPacker initial(*this);
@@ -234,7 +386,7 @@ int GridAtlasPacker::pack(GlyphGeometry *glyphs, int count) {
             else if (width > 0 && height > 0) {
                 double bestAlignedScale = 0;
                 int bestCols = 0, bestAlignedCols = 0;
-                for (int q = (int) sqrt(cellCount)+1; q > 0; --q) {
+                for (int q = (int) sqrt(cellCount)+1; q > 0 && !isCancelled(cancellationToken); --q) {
                     int cols = q;
                     int rows = (cellCount+cols-1)/cols;
                     int tWidth = (width+spacing)/cols;
@@ -345,7 +497,7 @@ int GridAtlasPacker::pack(GlyphGeometry *glyphs, int count) {
                 double bestAlignedScale = 0;
                 int bestCols = 0, bestAlignedCols = 0;
                 // TODO optimize to only test up to sqrt(cellCount) cols and rows like in the above branch (for (int q = (int) sqrt(cellCount)+1; ...)
-                for (int cols = 1; cols < width; ++cols) {
+                for (int cols = 1; cols < width && !isCancelled(cancellationToken); ++cols) {
                     int rows = (cellCount+cols-1)/cols;
                     int tWidth = (width+spacing)/cols;
                     int tHeight = (height+spacing)/rows;
@@ -441,7 +593,7 @@ int GridAtlasPacker::pack(GlyphGeometry *glyphs, int count) {
     if (width < 0 || height < 0) {
         if (columns <= 0) {
             double bestRating = -1;
-            for (int q = (int) sqrt(cellCount)+1; q > 0; --q) {
+            for (int q = (int) sqrt(cellCount)+1; q > 0 && !isCancelled(cancellationToken); --q) {
                 int cols = q;
                 int rows = (cellCount+cols-1)/cols;
                 int curWidth = cols*cellWidth, curHeight = rows*cellHeight;
@@ -466,16 +618,20 @@ int GridAtlasPacker::pack(GlyphGeometry *glyphs, int count) {
         width = columns*cellWidth, height = rows*cellHeight;
         raiseToConstraint(width, height, dimensionsConstraint);
         // raiseToConstraint may have increased dimensions significantly, rerun if cell dimensions can be optimized.
-        if (dimensionsConstraint != DimensionsConstraint::NONE && initial.cellWidth < 0 && initial.cellHeight < 0) {
+        // (It leaves them as they are for MINIMUM_MEMORY, so there is nothing to gain from a rerun.)
+        if (dimensionsConstraint != DimensionsConstraint::NONE && dimensionsConstraint != DimensionsConstraint::MINIMUM_MEMORY && initial.cellWidth < 0 && initial.cellHeight < 0) {
             cellWidth = initial.cellWidth;
             cellHeight = initial.cellHeight;
             columns = initial.columns;
             rows = initial.rows;
             scale = initial.scale;
-            return pack(glyphs, count);
+            return packGrid(glyphs, count);
         }
     }
 
+    if (isCancelled(cancellationToken))
+        return -1;
+
     if (columns < 0) {
         columns = (width+spacing)/cellWidth;
         rows = (cellCount+columns-1)/columns;
@@ -483,14 +639,7 @@ int GridAtlasPacker::pack(GlyphGeometry *glyphs, int count) {
     if (rows*cellHeight > height)
         rows = height/cellHeight;
 
-    GlyphGeometry::GlyphAttributes attribs = { };
-    attribs.scale = scale;
-    attribs.range = unitRange+pxRange/scale;
-    attribs.innerPadding = innerUnitPadding+1/scale*innerPxPadding;
-    attribs.outerPadding = outerUnitPadding+1/scale*outerPxPadding;
-    attribs.miterLimit = miterLimit;
-    attribs.pxAlignOriginX = pxAlignOriginX;
-    attribs.pxAlignOriginY = pxAlignOriginY;
+    GlyphGeometry::GlyphAttributes attribs = glyphAttributes();
     int col = 0, row = 0;
     for (GlyphGeometry *glyph = glyphs, *end = glyphs+count; glyph < end; ++glyph) {
         if (!glyph->isWhitespace()) {
@@ -564,6 +713,10 @@ void GridAtlasPacker::setMinimumScale(double minScale) {
     this->minScale = minScale;
 }
 
+void GridAtlasPacker::setScaleHint(double scaleHint) {
+    this->scaleHint = scaleHint;
+}
+
 void GridAtlasPacker::setUnitRange(msdfgen::Range unitRange) {
     this->unitRange = unitRange;
 }
@@ -600,6 +753,18 @@ void GridAtlasPacker::setOuterPixelPadding(const Padding &padding) {
     outerPxPadding = padding;
 }
 
+void GridAtlasPacker::setVariableCellWidths(bool variable) {
+    variableCellWidths = variable;
+}
+
+void GridAtlasPacker::setThreadCount(int threadCount) {
+    this->threadCount = threadCount;
+}
+
+void GridAtlasPacker::setCancellationToken(const CancellationToken *cancellationToken) {
+    this->cancellationToken = cancellationToken;
+}
+
 void GridAtlasPacker::getDimensions(int &width, int &height) const {
     width = this->width, height = this->height;
 }
@@ -633,4 +798,20 @@ bool GridAtlasPacker::hasCutoff() const {
     return cutoff;
 }
 
+const std::vector<int> &GridAtlasPacker::getRowLengths() const {
+    return rowLengths;
+}
+
+const std::vector<int> &GridAtlasPacker::getRowCellWidths() const {
+    return rowCellWidths;
+}
+
+void GridAtlasPacker::getUniformDimensions(int &width, int &height) const {
+    width = uniformWidth, height = uniformHeight;
+}
+
+int GridAtlasPacker::getFitAttemptCount() const {
+    return fitAttempts;
+}
+
 }
@@ -1,8 +1,10 @@
 
 #pragma once
 
+#include <vector>
 #include "Padding.h"
 #include "GlyphGeometry.h"
+#include "CancellationToken.h"
 
 namespace msdf_atlas {
 
@@ -40,6 +42,8 @@ public:
     void setScale(double scale);
     /// Sets the minimum glyph scale
     void setMinimumScale(double minScale);
+    /// Sets an expected glyph scale (e.g. the result of a previous run), from which the scale search starts instead of the estimate
+    void setScaleHint(double scaleHint);
     /// Sets the unit component of the total distance range
     void setUnitRange(msdfgen::Range unitRange);
     /// Sets the pixel component of the total distance range
@@ -57,6 +61,12 @@ public:
     void setInnerPixelPadding(const Padding &padding);
     /// Sets the pixel component of width of additional padding around each glyph quad
     void setOuterPixelPadding(const Padding &padding);
+    /// Sets whether each row's cells should only be as wide as the row's widest glyph, which requires a horizontally unfixed origin
+    void setVariableCellWidths(bool variable);
+    /// Sets the number of threads the glyph bounds are evaluated on for each candidate scale
+    void setThreadCount(int threadCount);
+    /// Sets a token which interrupts the search for scale and grid layout when cancelled (pack then fails)
+    void setCancellationToken(const CancellationToken *cancellationToken);
 
     /// Outputs the atlas's final dimensions
     void getDimensions(int &width, int &height) const;
@@ -74,6 +84,14 @@ public:
     void getFixedOrigin(double &x, double &y);
     /// Returns true if the explicitly constrained cell dimensions aren't large enough to fit each glyph fully
     bool hasCutoff() const;
+    /// Returns the number of cells in each row (top to bottom) of a variable cell width grid, empty for a uniform grid
+    const std::vector<int> &getRowLengths() const;
+    /// Returns the cell width of each row (top to bottom) of a variable cell width grid, empty for a uniform grid
+    const std::vector<int> &getRowCellWidths() const;
+    /// Outputs the dimensions the atlas would have as a uniform grid, only valid for a variable cell width grid
+    void getUniformDimensions(int &width, int &height) const;
+    /// Returns the number of times the glyphs were fitted into a cell during the last pack, including the scale search
+    int getFitAttemptCount() const;
 
 private:
     int columns, rows;
@@ -92,16 +110,27 @@ private:
     bool pxAlignOriginX, pxAlignOriginY;
     Padding innerUnitPadding, outerUnitPadding;
     Padding innerPxPadding, outerPxPadding;
+    double scaleHint;
     double scaleMaximizationTolerance;
     double alignedColumnsBias;
     bool cutoff;
+    bool variableCellWidths;
+    std::vector<int> rowLengths, rowCellWidths;
+    int uniformWidth, uniformHeight;
+    int fitAttempts;
+    int threadCount;
+    const CancellationToken *cancellationToken;
 
     static void lowerToConstraint(int &width, int &height, DimensionsConstraint constraint);
     static void raiseToConstraint(int &width, int &height, DimensionsConstraint constraint);
 
     double dimensionsRating(int width, int height, bool aligned) const;
+    GlyphGeometry::GlyphAttributes glyphAttributes() const;
+    int packGrid(GlyphGeometry *glyphs, int count);
+    int layoutRows(const std::vector<int> &glyphCellWidths, int width, int maxRowLength);
+    int packVariableWidths(GlyphGeometry *glyphs, int count, bool fixedWidth, bool fixedHeight, int maxRowLength);
     msdfgen::Shape::Bounds getMaxBounds(double &maxWidth, double &maxHeight, GlyphGeometry *glyphs, int count, double scale, double outerRange) const;
-    double scaleToFit(GlyphGeometry *glyphs, int count, int cellWidth, int cellHeight, msdfgen::Shape::Bounds &maxBounds, double &maxWidth, double &maxHeight) const;
+    double scaleToFit(GlyphGeometry *glyphs, int count, int cellWidth, int cellHeight, msdfgen::Shape::Bounds &maxBounds, double &maxWidth, double &maxHeight);
 
 };
 
@@ -22,13 +22,28 @@ public:
     ImmediateAtlasGenerator(int width, int height);
     template <typename... ARGS>
     ImmediateAtlasGenerator(int width, int height, ARGS... storageArgs);
+    /// Creates with an atlas storage that already contains the bitmaps of the glyphs, e.g. a prebuilt atlas
+    ImmediateAtlasGenerator(AtlasStorage &&storage, const GlyphGeometry *glyphs, int count);
     void generate(const GlyphGeometry *glyphs, int count);
+    /// Appends glyphs to the layout without generating their bitmaps
+    void reserve(const GlyphGeometry *glyphs, int count);
+    /// Generates bitmaps of reserved glyphs in the calling thread only, may be called concurrently for different glyphs
+    void render(const GlyphGeometry *glyphs, int count);
     void rearrange(int width, int height, const Remap *remapping, int count);
     void resize(int width, int height);
     /// Sets attributes for the generator function
     void setAttributes(const GeneratorAttributes &attributes);
     /// Sets the number of threads to be run by generate
     void setThreadCount(int threadCount);
+    /// Sets whether the threads run by generate should be pinned to different CPUs
+    void setThreadPinning(bool pinThreads);
+    /// Sets whether the threads run by generate should be grouped by NUMA nodes, each group generating glyphs from its own band of rows
+    /// (use together with a storage cleared with the same affinity, such as BitmapAtlasStorage(width, height, threadCount, true))
+    void setNumaAffinity(bool numaAffinity);
+    /// Sets a token which stops generate and render when cancelled, leaving the remaining glyphs empty
+    void setCancellationToken(const CancellationToken *cancellationToken);
+    /// Sets a function to report the progress of generate by glyphs
+    void setProgressCallback(const ProgressCallback &progressCallback);
     /// Allows access to the underlying AtlasStorage
     const AtlasStorage &atlasStorage() const;
     /// Returns the layout of the contained glyphs as a list of GlyphBoxes
@@ -41,6 +56,16 @@ private:
     std::vector<byte> errorCorrectionBuffer;
     GeneratorAttributes attributes;
     int threadCount;
+    bool pinThreads;
+    bool numaAffinity;
+    const CancellationToken *cancellationToken;
+    ProgressCallback progressCallback;
+
+    /// Passes the thread count and NUMA affinity on to the storage if it implements setThreadCount
+    template <class S>
+    static auto configureStorage(S &storage, int threadCount, bool numaAffinity, int) -> decltype(storage.setThreadCount(threadCount, numaAffinity), void());
+    template <class S>
+    static void configureStorage(S &storage, int threadCount, bool numaAffinity, long);
 
 };
 
@@ -2,28 +2,36 @@
 #include "ImmediateAtlasGenerator.h"
 
 #include <algorithm>
+#include "bitmap-blit.h"
 
 namespace msdf_atlas {
 
 template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
-ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::ImmediateAtlasGenerator() : threadCount(1) { }
+ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::ImmediateAtlasGenerator() : threadCount(1), pinThreads(false), numaAffinity(false), cancellationToken(nullptr) { }
 
 template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
-ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::ImmediateAtlasGenerator(int width, int height) : storage(width, height), threadCount(1) { }
+ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::ImmediateAtlasGenerator(int width, int height) : storage(width, height), threadCount(1), pinThreads(false), numaAffinity(false), cancellationToken(nullptr) { }
 
 template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
 template <typename... ARGS>
-ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::ImmediateAtlasGenerator(int width, int height, ARGS... storageArgs) : storage(width, height, storageArgs...), threadCount(1) { }
+ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::ImmediateAtlasGenerator(int width, int height, ARGS... storageArgs) : storage(width, height, storageArgs...), threadCount(1), pinThreads(false), numaAffinity(false), cancellationToken(nullptr) { }
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::ImmediateAtlasGenerator(AtlasStorage &&storage, const GlyphGeometry *glyphs, int count) : storage((AtlasStorage &&) storage), layout(glyphs, glyphs+count), threadCount(1), pinThreads(false), numaAffinity(false), cancellationToken(nullptr) { }
 
 template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
 void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::generate(const GlyphGeometry *glyphs, int count) {
+    reserve(glyphs, count);
     int maxBoxArea = 0;
+    bool rotation = false;
     for (int i = 0; i < count; ++i) {
-        GlyphBox box = glyphs[i];
-        maxBoxArea = std::max(maxBoxArea, box.rect.w*box.rect.h);
-        layout.push_back((GlyphBox &&) box);
+        int w, h;
+        glyphs[i].getBoxSize(w, h);
+        maxBoxArea = std::max(maxBoxArea, w*h);
+        rotation |= glyphs[i].isBoxRotated();
     }
-    int threadBufferSize = N*maxBoxArea;
+    // Rotated glyphs need a second half of the buffer to be rotated into
+    int threadBufferSize = (rotation ? 2 : 1)*N*maxBoxArea;
     if (threadCount*threadBufferSize > (int) glyphBuffer.size())
         glyphBuffer.resize(threadCount*threadBufferSize);
     if (threadCount*maxBoxArea > (int) errorCorrectionBuffer.size())
@@ -34,17 +42,68 @@ void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::generate(const GlyphGe
         threadAttributes[i].config.errorCorrection.buffer = errorCorrectionBuffer.data()+i*maxBoxArea;
     }
 
-    Workload([this, glyphs, &threadAttributes, threadBufferSize](int i, int threadNo) -> bool {
-        const GlyphGeometry &glyph = glyphs[i];
+    // With NUMA affinity, glyphs are processed from the bottom row up, so that each group of threads writes its own band of rows
+    std::vector<int> order;
+    if (numaAffinity) {
+        order.resize(count);
+        for (int i = 0; i < count; ++i)
+            order[i] = i;
+        std::stable_sort(order.begin(), order.end(), [glyphs](int a, int b) -> bool {
+            return glyphs[a].getBoxRect().y < glyphs[b].getBoxRect().y;
+        });
+    }
+
+    Workload(count).setCancellationToken(cancellationToken).setProgressCallback(progressCallback).setThreadPinning(pinThreads).setNumaAffinity(numaAffinity).finish([this, glyphs, &order, &threadAttributes, threadBufferSize](int i, int threadNo) -> bool {
+        const GlyphGeometry &glyph = glyphs[order.empty() ? i : order[i]];
         if (!glyph.isWhitespace()) {
             int l, b, w, h;
             glyph.getBoxRect(l, b, w, h);
-            msdfgen::BitmapRef<T, N> glyphBitmap(glyphBuffer.data()+threadNo*threadBufferSize, w, h);
+            T *threadBuffer = glyphBuffer.data()+threadNo*threadBufferSize;
+            msdfgen::BitmapRef<T, N> glyphBitmap(threadBuffer, w, h);
             GEN_FN(glyphBitmap, glyph, threadAttributes[threadNo]);
-            storage.put(l, b, msdfgen::BitmapConstRef<T, N>(glyphBitmap));
+            if (glyph.isBoxRotated()) {
+                msdfgen::BitmapRef<T, N> rotatedBitmap(threadBuffer+N*w*h, h, w);
+                rotateClockwise(rotatedBitmap, glyphBitmap);
+                storage.put(l, b, msdfgen::BitmapConstRef<T, N>(rotatedBitmap));
+            } else
+                storage.put(l, b, msdfgen::BitmapConstRef<T, N>(glyphBitmap));
         }
         return true;
-    }, count).finish(threadCount);
+    }, threadCount);
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::reserve(const GlyphGeometry *glyphs, int count) {
+    for (int i = 0; i < count; ++i)
+        layout.push_back((GlyphBox) glyphs[i]);
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::render(const GlyphGeometry *glyphs, int count) {
+    // Buffers are local to the call so that concurrent calls do not share them
+    std::vector<T> buffer;
+    std::vector<byte> errorCorrectionBuffer;
+    GeneratorAttributes threadAttributes = attributes;
+    for (int i = 0; i < count && !isCancelled(cancellationToken); ++i) {
+        const GlyphGeometry &glyph = glyphs[i];
+        if (!glyph.isWhitespace()) {
+            int l, b, w, h;
+            glyph.getBoxRect(l, b, w, h);
+            if (2*N*w*h > (int) buffer.size())
+                buffer.resize(2*N*w*h);
+            if (w*h > (int) errorCorrectionBuffer.size())
+                errorCorrectionBuffer.resize(w*h);
+            threadAttributes.config.errorCorrection.buffer = errorCorrectionBuffer.data();
+            msdfgen::BitmapRef<T, N> glyphBitmap(buffer.data(), w, h);
+            GEN_FN(glyphBitmap, glyph, threadAttributes);
+            if (glyph.isBoxRotated()) {
+                msdfgen::BitmapRef<T, N> rotatedBitmap(buffer.data()+N*w*h, h, w);
+                rotateClockwise(rotatedBitmap, glyphBitmap);
+                storage.put(l, b, msdfgen::BitmapConstRef<T, N>(rotatedBitmap));
+            } else
+                storage.put(l, b, msdfgen::BitmapConstRef<T, N>(glyphBitmap));
+        }
+    }
 }
 
 template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
@@ -53,12 +112,14 @@ void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::rearrange(int width, i
         layout[remapping[i].index].rect.x = remapping[i].target.x;
         layout[remapping[i].index].rect.y = remapping[i].target.y;
     }
+    configureStorage(storage, threadCount, numaAffinity, 0);
     AtlasStorage newStorage((AtlasStorage &&) storage, width, height, remapping, count);
     storage = (AtlasStorage &&) newStorage;
 }
 
 template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
 void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::resize(int width, int height) {
+    configureStorage(storage, threadCount, numaAffinity, 0);
     AtlasStorage newStorage((AtlasStorage &&) storage, width, height);
     storage = (AtlasStorage &&) newStorage;
 }
@@ -73,11 +134,41 @@ void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::setThreadCount(int thr
     this->threadCount = threadCount;
 }
 
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::setThreadPinning(bool pinThreads) {
+    this->pinThreads = pinThreads;
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::setNumaAffinity(bool numaAffinity) {
+    this->numaAffinity = numaAffinity;
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::setCancellationToken(const CancellationToken *cancellationToken) {
+    this->cancellationToken = cancellationToken;
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::setProgressCallback(const ProgressCallback &progressCallback) {
+    this->progressCallback = progressCallback;
+}
+
 template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
 const AtlasStorage &ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::atlasStorage() const {
     return storage;
 }
 
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+template <class S>
+auto ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::configureStorage(S &storage, int threadCount, bool numaAffinity, int) -> decltype(storage.setThreadCount(threadCount, numaAffinity), void()) {
+    storage.setThreadCount(threadCount, numaAffinity);
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+template <class S>
+void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::configureStorage(S &, int, bool, long) { }
+
 template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
 const std::vector<GlyphBox> &ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::getLayout() const {
     return layout;
@@ -14,31 +14,66 @@ static void removeFromUnorderedVector(std::vector<T> &vector, size_t index) {
     vector.pop_back();
 }
 
-int RectanglePacker::rateFit(int w, int h, int sw, int sh) {
-    return std::min(sw-w, sh-h);
+int RectanglePacker::rateFit(int w, int h, int sw, int sh) const {
+    switch (fitRule) {
+        case PackingFitRule::BEST_LONG_SIDE_FIT:
+            return std::max(sw-w, sh-h);
+        case PackingFitRule::BEST_AREA_FIT:
+            return sw*sh-w*h;
+        case PackingFitRule::BEST_SHORT_SIDE_FIT:
+        default:
+            return std::min(sw-w, sh-h);
+    }
 }
 
 RectanglePacker::RectanglePacker() : RectanglePacker(0, 0) { }
 
-RectanglePacker::RectanglePacker(int width, int height) {
+RectanglePacker::RectanglePacker(int width, int height) : width(std::max(width, 0)), height(std::max(height, 0)), fitRule(PackingFitRule::BEST_SHORT_SIDE_FIT) {
     if (width > 0 && height > 0)
         spaces.push_back(Rectangle { 0, 0, width, height });
 }
 
+RectanglePacker::RectanglePacker(int width, int height, const Rectangle *occupied, int occupiedCount) : RectanglePacker(width, height) {
+    for (int i = 0; i < occupiedCount; ++i)
+        occupy(occupied[i]);
+}
+
 void RectanglePacker::expand(int width, int height) {
     if (width > 0 && height > 0) {
-        int oldWidth = 0, oldHeight = 0;
-        for (const Rectangle &space : spaces) {
-            if (space.x+space.w > oldWidth)
-                oldWidth = space.x+space.w;
-            if (space.y+space.h > oldHeight)
-                oldHeight = space.y+space.h;
-        }
+        // The previous area may be fully occupied up to its edges, so its extent cannot be derived from the free spaces
+        int oldWidth = this->width, oldHeight = this->height;
+        this->width = width, this->height = height;
         spaces.push_back(Rectangle { 0, 0, width, height });
         splitSpace(int(spaces.size()-1), oldWidth, oldHeight);
     }
 }
 
+void RectanglePacker::setFitRule(PackingFitRule fitRule) {
+    this->fitRule = fitRule;
+}
+
+void RectanglePacker::occupy(const Rectangle &rect) {
+    // Subtract the rectangle from each overlapping space, leaving up to four disjoint pieces
+    for (size_t i = spaces.size(); i-- > 0;) {
+        Rectangle space = spaces[i];
+        int l = std::max(space.x, rect.x), r = std::min(space.x+space.w, rect.x+rect.w);
+        int b = std::max(space.y, rect.y), t = std::min(space.y+space.h, rect.y+rect.h);
+        if (l >= r || b >= t)
+            continue;
+        removeFromUnorderedVector(spaces, i);
+        Rectangle pieces[4] = {
+            { space.x, space.y, space.w, b-space.y },
+            { space.x, t, space.w, space.y+space.h-t },
+            { space.x, b, l-space.x, t-b },
+            { r, b, space.x+space.w-r, t-b }
+        };
+        for (const Rectangle &piece : pieces) {
+            if (piece.w > 0 && piece.h > 0)
+                spaces.push_back(piece);
+        }
+    }
+}
+
 void RectanglePacker::splitSpace(int index, int w, int h) {
     Rectangle space = spaces[index];
     removeFromUnorderedVector(spaces, index);
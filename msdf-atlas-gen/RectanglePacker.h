@@ -6,24 +6,41 @@
 
 namespace msdf_atlas {
 
+/// Rule by which the packer selects the free space for a rectangle
+enum class PackingFitRule {
+    /// Minimizes the shorter leftover side
+    BEST_SHORT_SIDE_FIT,
+    /// Minimizes the longer leftover side
+    BEST_LONG_SIDE_FIT,
+    /// Minimizes the leftover area
+    BEST_AREA_FIT
+};
+
 /// Guillotine 2D single bin packer
 class RectanglePacker {
 
 public:
     RectanglePacker();
     RectanglePacker(int width, int height);
+    /// Creates with the packing area partially occupied by previously packed rectangles
+    RectanglePacker(int width, int height, const Rectangle *occupied, int occupiedCount);
     /// Expands the packing area - both width and height must be greater or equal to the previous value
     void expand(int width, int height);
+    /// Sets the rule for selecting free spaces (BEST_SHORT_SIDE_FIT by default)
+    void setFitRule(PackingFitRule fitRule);
     /// Packs the rectangle array, returns how many didn't fit (0 on success)
     int pack(Rectangle *rectangles, int count);
     int pack(OrientedRectangle *rectangles, int count);
 
 private:
+    int width, height;
     std::vector<Rectangle> spaces;
+    PackingFitRule fitRule;
 
-    static int rateFit(int w, int h, int sw, int sh);
+    int rateFit(int w, int h, int sw, int sh) const;
 
     void splitSpace(int index, int w, int h);
+    void occupy(const Rectangle &rect);
 
 };
 
@@ -0,0 +1,72 @@
+
+#include "ShelfPacker.h"
+
+#include <vector>
+#include <algorithm>
+
+namespace msdf_atlas {
+
+ShelfPacker::ShelfPacker() : ShelfPacker(0, 0) { }
+
+ShelfPacker::ShelfPacker(int width, int height) : width(std::max(width, 0)), height(std::max(height, 0)) { }
+
+int ShelfPacker::pack(Rectangle *rectangles, int count) {
+    std::vector<int> order(count);
+    for (int i = 0; i < count; ++i)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [rectangles](int a, int b) -> bool {
+        return rectangles[a].h > rectangles[b].h || (rectangles[a].h == rectangles[b].h && rectangles[a].w > rectangles[b].w);
+    });
+    // Shelves are created in order of decreasing height, so the first shelf with enough free width always has enough height.
+    // The free widths are kept in a max segment tree to find it in logarithmic time
+    int leafCount = 1;
+    while (leafCount < count)
+        leafCount <<= 1;
+    std::vector<int> freeWidth(2*leafCount, -1);
+    std::vector<int> shelfX, shelfY;
+    int top = 0;
+    int remaining = 0;
+    for (int index : order) {
+        Rectangle &rect = rectangles[index];
+        int shelf = -1;
+        if (freeWidth[1] >= rect.w) {
+            int node = 1;
+            while (node < leafCount)
+                node = freeWidth[2*node] >= rect.w ? 2*node : 2*node+1;
+            shelf = node-leafCount;
+        } else if (rect.w <= width && top+rect.h <= height) {
+            shelf = (int) shelfX.size();
+            shelfX.push_back(0);
+            shelfY.push_back(top);
+            top += rect.h;
+        } else {
+            ++remaining;
+            continue;
+        }
+        rect.x = shelfX[shelf];
+        rect.y = shelfY[shelf];
+        shelfX[shelf] += rect.w;
+        int node = leafCount+shelf;
+        freeWidth[node] = width-shelfX[shelf];
+        while (node >>= 1)
+            freeWidth[node] = std::max(freeWidth[2*node], freeWidth[2*node+1]);
+    }
+    return remaining;
+}
+
+int ShelfPacker::pack(OrientedRectangle *rectangles, int count) {
+    std::vector<Rectangle> flatRectangles(count);
+    for (int i = 0; i < count; ++i) {
+        rectangles[i].rotated = rectangles[i].h > rectangles[i].w;
+        flatRectangles[i].w = rectangles[i].rotated ? rectangles[i].h : rectangles[i].w;
+        flatRectangles[i].h = rectangles[i].rotated ? rectangles[i].w : rectangles[i].h;
+    }
+    int result = pack(flatRectangles.data(), count);
+    for (int i = 0; i < count; ++i) {
+        rectangles[i].x = flatRectangles[i].x;
+        rectangles[i].y = flatRectangles[i].y;
+    }
+    return result;
+}
+
+}
@@ -0,0 +1,28 @@
+
+#pragma once
+
+#include "Rectangle.h"
+
+namespace msdf_atlas {
+
+/**
+ * Shelf 2D single bin packer - rectangles sorted by decreasing height are placed
+ * from left to right into the first horizontal shelf they fit (first-fit decreasing) in O(n log n).
+ * Much faster than RectanglePacker for very large numbers of rectangles but leaves more unused space
+ */
+class ShelfPacker {
+
+public:
+    ShelfPacker();
+    ShelfPacker(int width, int height);
+    /// Packs the rectangle array, returns how many didn't fit (0 on success)
+    int pack(Rectangle *rectangles, int count);
+    /// Packs the rectangle array, rotating rectangles taller than wide to lie flat on the shelves
+    int pack(OrientedRectangle *rectangles, int count);
+
+private:
+    int width, height;
+
+};
+
+}
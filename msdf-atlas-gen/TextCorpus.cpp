@@ -0,0 +1,156 @@
+
+#include "TextCorpus.h"
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include "utf8.h"
+#include "Workload.h"
+
+#define CORPUS_BLOCK_SIZE 0x400000
+#define CORPUS_MIN_BLOCK_SIZE 0x10000
+#define CORPUS_BUFFER_LIMIT 0x4000000
+#define CORPUS_PAGE_BITS 12
+#define CODEPOINT_COUNT 0x110000
+
+namespace msdf_atlas {
+
+/// Control characters and the byte order mark are not glyphs
+static bool isCountedCodepoint(unicode_t cp) {
+    return cp >= 0x20 && cp != 0x7f && cp != 0xfeff && cp < CODEPOINT_COUNT;
+}
+
+/// Moves position back to the beginning of the UTF-8 sequence it is in
+static size_t utf8SequenceStart(const char *buffer, size_t position) {
+    for (int i = 0; i < 3 && position > 0 && (buffer[position]&0xc0) == 0x80; ++i)
+        --position;
+    return position;
+}
+
+TextCorpus::TextCorpus() : frequencies(CODEPOINT_COUNT>>CORPUS_PAGE_BITS), total(0), codepointCount(0) { }
+
+void TextCorpus::countCodepoints(CodepointCounts &counts, const char *utf8String, size_t length) {
+    utf8DecodeEach([&counts](unicode_t cp) {
+        if (isCountedCodepoint(cp)) {
+            std::vector<unsigned long long> &page = counts[cp>>CORPUS_PAGE_BITS];
+            if (page.empty())
+                page.resize(1<<CORPUS_PAGE_BITS);
+            ++page[cp&((1<<CORPUS_PAGE_BITS)-1)];
+        }
+    }, utf8String, length);
+}
+
+bool TextCorpus::scanFiles(const char *const *filenames, int fileCount, int threadCount) {
+    threadCount = std::max(threadCount, 1);
+    std::vector<CodepointCounts> threadCounts(threadCount, CodepointCounts(CODEPOINT_COUNT>>CORPUS_PAGE_BITS));
+    // Each thread gets a block of the buffer, whose total size is limited for large thread counts
+    size_t blockSize = std::max(std::min((size_t) CORPUS_BLOCK_SIZE, (size_t) CORPUS_BUFFER_LIMIT/threadCount), (size_t) CORPUS_MIN_BLOCK_SIZE);
+    std::vector<char> buffer((size_t) threadCount*blockSize);
+    std::vector<size_t> blockBoundaries(threadCount+1);
+    bool success = true;
+    for (int fileIndex = 0; fileIndex < fileCount && success; ++fileIndex) {
+        FILE *f = fopen(filenames[fileIndex], "rb");
+        if (!f) {
+            success = false;
+            break;
+        }
+        size_t carry = 0;
+        bool eof = false;
+        while (!eof) {
+            size_t length = carry+fread(buffer.data()+carry, 1, buffer.size()-carry, f);
+            eof = length < buffer.size();
+            if (ferror(f)) {
+                success = false;
+                break;
+            }
+            // An incomplete sequence at the end of the buffer is carried over to the next read
+            size_t end = eof ? length : utf8SequenceStart(buffer.data(), length-1);
+            blockBoundaries[0] = 0;
+            for (int i = 1; i < threadCount; ++i)
+                blockBoundaries[i] = std::max(blockBoundaries[i-1], utf8SequenceStart(buffer.data(), end*i/threadCount));
+            blockBoundaries[threadCount] = end;
+            Workload(threadCount).finish([&buffer, &blockBoundaries, &threadCounts](int i, int threadNo) -> bool {
+                countCodepoints(threadCounts[threadNo], buffer.data()+blockBoundaries[i], blockBoundaries[i+1]-blockBoundaries[i]);
+                return true;
+            }, threadCount);
+            carry = length-end;
+            memmove(buffer.data(), buffer.data()+end, carry);
+        }
+        fclose(f);
+    }
+    for (const CodepointCounts &counts : threadCounts)
+        accumulate(counts);
+    return success;
+}
+
+void TextCorpus::scan(const char *utf8String, size_t length) {
+    CodepointCounts counts(CODEPOINT_COUNT>>CORPUS_PAGE_BITS);
+    countCodepoints(counts, utf8String, length);
+    accumulate(counts);
+}
+
+void TextCorpus::merge(const TextCorpus &other) {
+    accumulate(other.frequencies);
+}
+
+void TextCorpus::accumulate(const CodepointCounts &counts) {
+    for (size_t pageIndex = 0; pageIndex < counts.size(); ++pageIndex) {
+        const std::vector<unsigned long long> &page = counts[pageIndex];
+        if (page.empty())
+            continue;
+        std::vector<unsigned long long> &frequencyPage = frequencies[pageIndex];
+        if (frequencyPage.empty())
+            frequencyPage.resize(page.size());
+        for (size_t i = 0; i < page.size(); ++i) {
+            if (page[i]) {
+                codepointCount += !frequencyPage[i];
+                frequencyPage[i] += page[i];
+                total += page[i];
+            }
+        }
+    }
+}
+
+unsigned long long TextCorpus::getFrequency(unicode_t codepoint) const {
+    if (codepoint < CODEPOINT_COUNT) {
+        const std::vector<unsigned long long> &page = frequencies[codepoint>>CORPUS_PAGE_BITS];
+        if (!page.empty())
+            return page[codepoint&((1<<CORPUS_PAGE_BITS)-1)];
+    }
+    return 0;
+}
+
+unsigned long long TextCorpus::getTotal() const {
+    return total;
+}
+
+size_t TextCorpus::getCodepointCount() const {
+    return codepointCount;
+}
+
+double TextCorpus::getCharset(Charset &charset, size_t maxCount, double coverage) const {
+    std::vector<unicode_t> ranking;
+    ranking.reserve(codepointCount);
+    for (size_t pageIndex = 0; pageIndex < frequencies.size(); ++pageIndex) {
+        const std::vector<unsigned long long> &page = frequencies[pageIndex];
+        for (size_t i = 0; i < page.size(); ++i)
+            if (page[i])
+                ranking.push_back(unicode_t(pageIndex<<CORPUS_PAGE_BITS|i));
+    }
+    std::stable_sort(ranking.begin(), ranking.end(), [this](unicode_t a, unicode_t b) -> bool {
+        return getFrequency(a) > getFrequency(b);
+    });
+    if (maxCount && ranking.size() > maxCount)
+        ranking.resize(maxCount);
+    unsigned long long covered = 0;
+    size_t selected = 0;
+    for (; selected < ranking.size(); ++selected) {
+        if (coverage < 1 && (double) covered >= coverage*(double) total)
+            break;
+        covered += getFrequency(ranking[selected]);
+    }
+    charset.add(ranking.data(), selected);
+    return total ? (double) covered/(double) total : 1;
+}
+
+}
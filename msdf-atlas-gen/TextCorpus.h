@@ -0,0 +1,45 @@
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "types.h"
+#include "Charset.h"
+
+namespace msdf_atlas {
+
+/// Counts the occurrences of Unicode codepoints in a body of UTF-8 text
+class TextCorpus {
+
+public:
+    TextCorpus();
+    /// Scans UTF-8 text files in blocks, processed in parallel, and accumulates the occurrences of their codepoints, returns false if a file could not be read
+    bool scanFiles(const char *const *filenames, int fileCount, int threadCount);
+    /// Accumulates the occurrences of codepoints in a UTF-8 string of the given length
+    void scan(const char *utf8String, size_t length);
+    /// Adds the occurrences counted by another corpus
+    void merge(const TextCorpus &other);
+
+    /// Returns the number of occurrences of a codepoint
+    unsigned long long getFrequency(unicode_t codepoint) const;
+    /// Returns the total number of counted occurrences
+    unsigned long long getTotal() const;
+    /// Returns the number of distinct codepoints that occurred
+    size_t getCodepointCount() const;
+    /// Outputs the codepoints that occurred, limited to the maxCount most frequent (if non-zero) which together cover at least the given fraction of all occurrences, returns the fraction actually covered
+    double getCharset(Charset &charset, size_t maxCount = 0, double coverage = 1) const;
+
+private:
+    /// Occurrences of codepoints in pages of consecutive codepoints, only allocated for pages which occurred
+    typedef std::vector<std::vector<unsigned long long> > CodepointCounts;
+
+    CodepointCounts frequencies;
+    unsigned long long total;
+    size_t codepointCount;
+
+    static void countCodepoints(CodepointCounts &counts, const char *utf8String, size_t length);
+    void accumulate(const CodepointCounts &counts);
+
+};
+
+}
@@ -1,32 +1,240 @@
 
 #include "TightAtlasPacker.h"
 
+#include <cmath>
 #include <vector>
-#include "Rectangle.h"
+#include <algorithm>
 #include "rectangle-packing.h"
+#include "Workload.h"
 #include "size-selectors.h"
+#include "scale-search.hpp"
 
 namespace msdf_atlas {
 
+#define SHELF_SEARCH_THRESHOLD 16384
+#define PACKING_EFFICIENCY_ESTIMATE .5
+
+static const PackingHeuristic PACKING_PORTFOLIO[] = {
+    { PackingOrder::INPUT, PackingFitRule::BEST_SHORT_SIDE_FIT },
+    { PackingOrder::INPUT, PackingFitRule::BEST_LONG_SIDE_FIT },
+    { PackingOrder::INPUT, PackingFitRule::BEST_AREA_FIT },
+    { PackingOrder::HEIGHT, PackingFitRule::BEST_SHORT_SIDE_FIT },
+    { PackingOrder::HEIGHT, PackingFitRule::BEST_LONG_SIDE_FIT },
+    { PackingOrder::HEIGHT, PackingFitRule::BEST_AREA_FIT },
+    { PackingOrder::AREA, PackingFitRule::BEST_SHORT_SIDE_FIT },
+    { PackingOrder::AREA, PackingFitRule::BEST_LONG_SIDE_FIT },
+    { PackingOrder::AREA, PackingFitRule::BEST_AREA_FIT },
+    { PackingOrder::PERIMETER, PackingFitRule::BEST_SHORT_SIDE_FIT },
+    { PackingOrder::PERIMETER, PackingFitRule::BEST_LONG_SIDE_FIT },
+    { PackingOrder::PERIMETER, PackingFitRule::BEST_AREA_FIT },
+    { PackingOrder::MAX_SIDE, PackingFitRule::BEST_SHORT_SIDE_FIT },
+    { PackingOrder::MAX_SIDE, PackingFitRule::BEST_LONG_SIDE_FIT },
+    { PackingOrder::MAX_SIDE, PackingFitRule::BEST_AREA_FIT }
+};
+static const int PACKING_PORTFOLIO_SIZE = int(sizeof(PACKING_PORTFOLIO)/sizeof(*PACKING_PORTFOLIO));
+
+/// Aspect ratios (width / height) searched concurrently when the dimensions are unconstrained
+static const double ASPECT_RATIOS[] = { 1., 5./4., 4./5., 4./3., 3./4., 3./2., 2./3., 2., 1./2., 3., 1./3., 4., 1./4. };
+static const int ASPECT_RATIO_COUNT = int(sizeof(ASPECT_RATIOS)/sizeof(*ASPECT_RATIOS));
+
+/// Modeled GPU memory as the cost of atlas dimensions
+struct AtlasMemoryCost {
+    const GpuMemoryModel *model;
+
+    size_t operator()(int width, int height) const {
+        return model->allocatedBytes(width, height);
+    }
+};
+
 TightAtlasPacker::TightAtlasPacker() :
     width(-1), height(-1),
     spacing(0),
     dimensionsConstraint(DimensionsConstraint::POWER_OF_TWO_SQUARE),
+    maxWidth(0), maxHeight(0),
+    memoryModel(),
     scale(-1),
     minScale(1),
     unitRange(0),
     pxRange(0),
     miterLimit(0),
     pxAlignOriginX(false), pxAlignOriginY(false),
-    scaleMaximizationTolerance(.001)
+    scaleHint(0),
+    scaleMaximizationTolerance(.001),
+    hotCoverage(0),
+    hotRegion(),
+    cancellationToken(nullptr),
+    glyphArea(0), partitionArea(0),
+    packAttempts(0),
+    heuristicPortfolio(false),
+    fastPacking(false),
+    partitionCount(0),
+    allowRotation(false),
+    threadCount(1)
 { }
 
-int TightAtlasPacker::tryPack(GlyphGeometry *glyphs, int count, DimensionsConstraint dimensionsConstraint, int &width, int &height, double scale) const {
-    // Wrap glyphs into boxes
-    std::vector<Rectangle> rectangles;
-    std::vector<GlyphGeometry *> rectangleGlyphs;
-    rectangles.reserve(count);
-    rectangleGlyphs.reserve(count);
+void TightAtlasPacker::expandToAllocation(int &width, int &height) const {
+    // The rest of the modeled allocation is occupied anyway, so it is made available to the glyphs (e.g. for a larger scale)
+    int allocatedWidth = width, allocatedHeight = height;
+    memoryModel.allocatedDimensions(allocatedWidth, allocatedHeight);
+    width = maxWidth > 0 ? std::min(allocatedWidth, maxWidth) : allocatedWidth;
+    height = maxHeight > 0 ? std::min(allocatedHeight, maxHeight) : allocatedHeight;
+}
+
+template <typename RectangleType>
+int TightAtlasPacker::packRectangleArray(RectangleType *rectangles, int count, DimensionsConstraint dimensionsConstraint, int &width, int &height, bool shelves) const {
+    const PackingHeuristic *heuristics = heuristicPortfolio ? PACKING_PORTFOLIO : nullptr;
+    int heuristicCount = heuristicPortfolio ? PACKING_PORTFOLIO_SIZE : 0;
+    if (shelves) {
+        if (width < 0 || height < 0) {
+            std::pair<int, int> dimensions = std::make_pair(width, height);
+            switch (dimensionsConstraint) {
+                case DimensionsConstraint::NONE:
+                    dimensions = packRectanglesMinimumArea<ShelfPacker>(rectangles, count, spacing, ASPECT_RATIOS, ASPECT_RATIO_COUNT, maxWidth, maxHeight, threadCount);
+                    break;
+                case DimensionsConstraint::MINIMUM_MEMORY:
+                    dimensions = packRectanglesMinimumCost<ShelfPacker>(rectangles, count, spacing, ASPECT_RATIOS, ASPECT_RATIO_COUNT, maxWidth, maxHeight, AtlasMemoryCost { &memoryModel }, threadCount);
+                    break;
+                case DimensionsConstraint::POWER_OF_TWO_SQUARE:
+                    dimensions = packRectangles<SquarePowerOfTwoSizeSelector, ShelfPacker>(rectangles, count, spacing);
+                    break;
+                case DimensionsConstraint::POWER_OF_TWO_RECTANGLE:
+                    dimensions = packRectangles<PowerOfTwoSizeSelector, ShelfPacker>(rectangles, count, spacing);
+                    break;
+                case DimensionsConstraint::MULTIPLE_OF_FOUR_SQUARE:
+                    dimensions = packRectangles<SquareSizeSelector<4>, ShelfPacker>(rectangles, count, spacing);
+                    break;
+                case DimensionsConstraint::EVEN_SQUARE:
+                    dimensions = packRectangles<SquareSizeSelector<2>, ShelfPacker>(rectangles, count, spacing);
+                    break;
+                case DimensionsConstraint::SQUARE:
+                default:
+                    dimensions = packRectangles<SquareSizeSelector<>, ShelfPacker>(rectangles, count, spacing);
+                    break;
+            }
+            if (!(dimensions.first > 0 && dimensions.second > 0))
+                return -1;
+            width = dimensions.first, height = dimensions.second;
+            if (dimensionsConstraint == DimensionsConstraint::MINIMUM_MEMORY)
+                expandToAllocation(width, height);
+            return 0;
+        }
+        return packRectangles<ShelfPacker>(rectangles, count, width, height, spacing);
+    }
+    if (width < 0 || height < 0) {
+        std::pair<int, int> dimensions = std::make_pair(width, height);
+        switch (dimensionsConstraint) {
+            case DimensionsConstraint::NONE:
+                dimensions = packRectanglesMinimumArea(rectangles, count, spacing, ASPECT_RATIOS, ASPECT_RATIO_COUNT, maxWidth, maxHeight, threadCount);
+                break;
+            case DimensionsConstraint::MINIMUM_MEMORY:
+                dimensions = packRectanglesMinimumCost<RectanglePacker>(rectangles, count, spacing, ASPECT_RATIOS, ASPECT_RATIO_COUNT, maxWidth, maxHeight, AtlasMemoryCost { &memoryModel }, threadCount);
+                break;
+            case DimensionsConstraint::POWER_OF_TWO_SQUARE:
+                dimensions = packRectangles<SquarePowerOfTwoSizeSelector>(rectangles, count, spacing, heuristics, heuristicCount, threadCount);
+                break;
+            case DimensionsConstraint::POWER_OF_TWO_RECTANGLE:
+                dimensions = packRectangles<PowerOfTwoSizeSelector>(rectangles, count, spacing, heuristics, heuristicCount, threadCount);
+                break;
+            case DimensionsConstraint::MULTIPLE_OF_FOUR_SQUARE:
+                dimensions = packRectangles<SquareSizeSelector<4> >(rectangles, count, spacing, heuristics, heuristicCount, threadCount);
+                break;
+            case DimensionsConstraint::EVEN_SQUARE:
+                dimensions = packRectangles<SquareSizeSelector<2> >(rectangles, count, spacing, heuristics, heuristicCount, threadCount);
+                break;
+            case DimensionsConstraint::SQUARE:
+            default:
+                dimensions = packRectangles<SquareSizeSelector<> >(rectangles, count, spacing, heuristics, heuristicCount, threadCount);
+                break;
+        }
+        if (!(dimensions.first > 0 && dimensions.second > 0))
+            return -1;
+        width = dimensions.first, height = dimensions.second;
+        if (dimensionsConstraint == DimensionsConstraint::MINIMUM_MEMORY)
+            expandToAllocation(width, height);
+        return 0;
+    }
+    return packRectangles(rectangles, count, width, height, spacing, heuristics, heuristicCount, threadCount);
+}
+
+template <typename RectangleType>
+int TightAtlasPacker::packPartitioned(RectangleType *rectangles, int count, DimensionsConstraint dimensionsConstraint, int &width, int &height, double &partitionArea, bool shelves) const {
+    partitionArea = 0;
+    if (partitionCount <= 1 || count < 2*partitionCount)
+        return packRectangleArray(rectangles, count, dimensionsConstraint, width, height, shelves);
+    // Partition into classes of similar height, each packed into its own square region in parallel
+    std::vector<int> order(count);
+    for (int i = 0; i < count; ++i)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [rectangles](int a, int b) -> bool {
+        return rectangles[a].h > rectangles[b].h;
+    });
+    std::vector<std::vector<RectangleType> > partitions(partitionCount);
+    for (int i = 0; i < partitionCount; ++i) {
+        for (int j = (long long) i*count/partitionCount, end = (long long) (i+1)*count/partitionCount; j < end; ++j)
+            partitions[i].push_back(rectangles[order[j]]);
+    }
+    std::vector<RectangleType> regions(partitionCount);
+    std::vector<RectangleType> *partitionData = partitions.data();
+    RectangleType *regionData = regions.data();
+    bool success = Workload(partitionCount).setGrainSize(1).finish([this, partitionData, regionData, shelves](int i, int) -> bool {
+        std::vector<RectangleType> &partition = partitionData[i];
+        std::pair<int, int> dimensions = shelves ?
+            packRectangles<SquareSizeSelector<>, ShelfPacker>(partition.data(), (int) partition.size(), spacing) :
+            packRectangles<SquareSizeSelector<> >(partition.data(), (int) partition.size(), spacing, heuristicPortfolio ? PACKING_PORTFOLIO : nullptr, heuristicPortfolio ? PACKING_PORTFOLIO_SIZE : 0, 1);
+        regionData[i].w = dimensions.first, regionData[i].h = dimensions.second;
+        return dimensions.first > 0 && dimensions.second > 0;
+    }, threadCount);
+    if (!success)
+        return -1;
+    // Pack the regions into the atlas - they are square, so even if marked as rotated, they occupy the same area
+    if (int result = packRectangleArray(regions.data(), partitionCount, dimensionsConstraint, width, height, shelves))
+        return result;
+    for (int i = 0, j = 0; i < partitionCount; ++i) {
+        for (const RectangleType &rect : partitions[i]) {
+            RectangleType &target = rectangles[order[j++]];
+            copyRectanglePlacement(target, rect);
+            target.x += regions[i].x;
+            target.y += regions[i].y;
+        }
+        partitionArea += (double) regions[i].w*regions[i].h;
+    }
+    return 0;
+}
+
+template <typename RectangleType>
+int TightAtlasPacker::packBoxes(RectangleType *rectangles, int count, int hotCount, DimensionsConstraint dimensionsConstraint, int &width, int &height, Rectangle &hotRegion, double &partitionArea, bool shelves) const {
+    if (hotCount > 0 && hotCount < count) {
+        // Hot glyphs are packed into a compact square region, which is then packed into the atlas as a single rectangle
+        int heuristicCount = heuristicPortfolio ? PACKING_PORTFOLIO_SIZE : 0;
+        std::pair<int, int> hotDimensions = shelves ?
+            packRectangles<SquareSizeSelector<>, ShelfPacker>(rectangles, hotCount, spacing) :
+            packRectangles<SquareSizeSelector<> >(rectangles, hotCount, spacing, PACKING_PORTFOLIO, heuristicCount, threadCount);
+        if (!(hotDimensions.first > 0 && hotDimensions.second > 0))
+            return -1;
+        std::vector<RectangleType> atlasRectangles;
+        atlasRectangles.reserve(count-hotCount+1);
+        atlasRectangles.push_back(RectangleType());
+        atlasRectangles[0].w = hotDimensions.first, atlasRectangles[0].h = hotDimensions.second;
+        atlasRectangles.insert(atlasRectangles.end(), rectangles+hotCount, rectangles+count);
+        if (int result = packPartitioned(atlasRectangles.data(), (int) atlasRectangles.size(), dimensionsConstraint, width, height, partitionArea, shelves))
+            return result;
+        // The region is square, so even if marked as rotated, it occupies the same area
+        const Rectangle &region = atlasRectangles[0];
+        for (int i = 0; i < hotCount; ++i)
+            rectangles[i].x += region.x, rectangles[i].y += region.y;
+        for (size_t i = 1; i < atlasRectangles.size(); ++i)
+            rectangles[hotCount+i-1] = atlasRectangles[i];
+        hotRegion = Rectangle { region.x, height-(region.y+region.h), region.w, region.h };
+    } else {
+        if (int result = packPartitioned(rectangles, count, dimensionsConstraint, width, height, partitionArea, shelves))
+            return result;
+        if (hotCount > 0)
+            hotRegion = Rectangle { 0, 0, width, height };
+    }
+    return 0;
+}
+
+GlyphGeometry::GlyphAttributes TightAtlasPacker::glyphAttributes(double scale) const {
     GlyphGeometry::GlyphAttributes attribs = { };
     attribs.scale = scale;
     attribs.range = unitRange+pxRange/scale;
@@ -35,9 +243,19 @@ int TightAtlasPacker::tryPack(GlyphGeometry *glyphs, int count, DimensionsConstr
     attribs.miterLimit = miterLimit;
     attribs.pxAlignOriginX = pxAlignOriginX;
     attribs.pxAlignOriginY = pxAlignOriginY;
+    return attribs;
+}
+
+int TightAtlasPacker::tryPack(GlyphGeometry *glyphs, int count, DimensionsConstraint dimensionsConstraint, int &width, int &height, double scale, Rectangle &hotRegion, double &partitionArea, bool shelves) const {
+    // Wrap glyphs into boxes
+    std::vector<OrientedRectangle> rectangles;
+    std::vector<GlyphGeometry *> rectangleGlyphs;
+    rectangles.reserve(count);
+    rectangleGlyphs.reserve(count);
+    GlyphGeometry::GlyphAttributes attribs = glyphAttributes(scale);
     for (GlyphGeometry *glyph = glyphs, *end = glyphs+count; glyph < end; ++glyph) {
         if (!glyph->isWhitespace()) {
-            Rectangle rect = { };
+            OrientedRectangle rect = { };
             glyph->wrapBox(attribs);
             glyph->getBoxSize(rect.w, rect.h);
             if (rect.w > 0 && rect.h > 0) {
@@ -46,83 +264,146 @@ int TightAtlasPacker::tryPack(GlyphGeometry *glyphs, int count, DimensionsConstr
             }
         }
     }
+    hotRegion = Rectangle();
+    partitionArea = 0;
     // No non-zero size boxes?
     if (rectangles.empty()) {
         if (width < 0 || height < 0)
             width = 0, height = 0;
         return 0;
     }
-    // Box rectangle packing
-    if (width < 0 || height < 0) {
-        std::pair<int, int> dimensions = std::make_pair(width, height);
-        switch (dimensionsConstraint) {
-            case DimensionsConstraint::POWER_OF_TWO_SQUARE:
-                dimensions = packRectangles<SquarePowerOfTwoSizeSelector>(rectangles.data(), rectangles.size(), spacing);
-                break;
-            case DimensionsConstraint::POWER_OF_TWO_RECTANGLE:
-                dimensions = packRectangles<PowerOfTwoSizeSelector>(rectangles.data(), rectangles.size(), spacing);
-                break;
-            case DimensionsConstraint::MULTIPLE_OF_FOUR_SQUARE:
-                dimensions = packRectangles<SquareSizeSelector<4> >(rectangles.data(), rectangles.size(), spacing);
-                break;
-            case DimensionsConstraint::EVEN_SQUARE:
-                dimensions = packRectangles<SquareSizeSelector<2> >(rectangles.data(), rectangles.size(), spacing);
-                break;
-            case DimensionsConstraint::SQUARE:
-            default:
-                dimensions = packRectangles<SquareSizeSelector<> >(rectangles.data(), rectangles.size(), spacing);
-                break;
+    // Select the most used glyphs and move them to the front
+    int hotCount = 0;
+    if ((int) glyphWeights.size() == count) {
+        std::vector<GlyphGeometry *> order(rectangleGlyphs);
+        std::stable_sort(order.begin(), order.end(), [this, glyphs](const GlyphGeometry *a, const GlyphGeometry *b) -> bool {
+            return glyphWeights[a-glyphs] > glyphWeights[b-glyphs];
+        });
+        double totalWeight = 0, hotWeight = 0;
+        for (const GlyphGeometry *glyph : order)
+            totalWeight += glyphWeights[glyph-glyphs];
+        while (hotCount < (int) order.size() && hotWeight < hotCoverage*totalWeight && glyphWeights[order[hotCount]-glyphs] > 0)
+            hotWeight += glyphWeights[order[hotCount++]-glyphs];
+        for (size_t i = 0; i < order.size(); ++i) {
+            int w, h;
+            order[i]->getBoxSize(w, h);
+            rectangles[i].w = w, rectangles[i].h = h;
         }
-        if (!(dimensions.first > 0 && dimensions.second > 0))
-            return -1;
-        width = dimensions.first, height = dimensions.second;
+        rectangleGlyphs = (std::vector<GlyphGeometry *> &&) order;
+    }
+    // Box rectangle packing
+    if (allowRotation) {
+        if (int result = packBoxes(rectangles.data(), (int) rectangles.size(), hotCount, dimensionsConstraint, width, height, hotRegion, partitionArea, shelves))
+            return result;
     } else {
-        if (int result = packRectangles(rectangles.data(), rectangles.size(), width, height, spacing))
+        std::vector<Rectangle> fixedRectangles(rectangles.begin(), rectangles.end());
+        if (int result = packBoxes(fixedRectangles.data(), (int) fixedRectangles.size(), hotCount, dimensionsConstraint, width, height, hotRegion, partitionArea, shelves))
             return result;
+        for (size_t i = 0; i < rectangles.size(); ++i)
+            rectangles[i].x = fixedRectangles[i].x, rectangles[i].y = fixedRectangles[i].y;
     }
     // Set glyph box placement
-    for (size_t i = 0; i < rectangles.size(); ++i)
-        rectangleGlyphs[i]->placeBox(rectangles[i].x, height-(rectangles[i].y+rectangles[i].h));
+    for (size_t i = 0; i < rectangles.size(); ++i) {
+        const OrientedRectangle &rect = rectangles[i];
+        rectangleGlyphs[i]->placeBox(rect.x, height-(rect.y+(rect.rotated ? rect.w : rect.h)));
+        rectangleGlyphs[i]->setBoxRotation(rect.rotated);
+    }
     return 0;
 }
 
-double TightAtlasPacker::packAndScale(GlyphGeometry *glyphs, int count) const {
-    bool lastResult = false;
-    int w = width, h = height;
-    #define TRY_PACK(scale) (lastResult = !tryPack(glyphs, count, DimensionsConstraint(), w, h, (scale)))
-    double minScale = 1, maxScale = 1;
-    if (TRY_PACK(1)) {
-        while (maxScale < 1e+32 && ((maxScale = 2*minScale), TRY_PACK(maxScale)))
-            minScale = maxScale;
-    } else {
-        while (minScale > 1e-32 && ((minScale = .5*maxScale), !TRY_PACK(minScale)))
-            maxScale = minScale;
+bool TightAtlasPacker::estimateScaleBounds(GlyphGeometry *glyphs, int count, int width, int height, double &lowerBound, double &upperBound) const {
+    // Box dimensions grow approximately linearly with scale, so measuring them at two scales yields a model of the total box area and of each box's sides.
+    // The first estimate is refined by measuring again at the estimated bounds, where the rounding of box dimensions matters less
+    double s0 = 1, s1 = 2;
+    int maxSide = std::max(width, height)+spacing;
+    double atlasArea = (double) (width+spacing)*(height+spacing);
+    for (int round = 0; round < 2; ++round) {
+        GlyphGeometry::GlyphAttributes attribs0 = glyphAttributes(s0), attribs1 = glyphAttributes(s1);
+        double areaA = 0, areaB = 0, areaC = 0;
+        double sideBound = 1e+32;
+        for (int i = 0; i < count; ++i) {
+            if (glyphs[i].isWhitespace())
+                continue;
+            int w0, h0, w1, h1;
+            glyphs[i].wrapBox(attribs0);
+            glyphs[i].getBoxSize(w0, h0);
+            glyphs[i].wrapBox(attribs1);
+            glyphs[i].getBoxSize(w1, h1);
+            if (!(w0 > 0 && h0 > 0))
+                continue;
+            double aw = (w1-w0)/(s1-s0), bw = w0-aw*s0+spacing;
+            double ah = (h1-h0)/(s1-s0), bh = h0-ah*s0+spacing;
+            areaA += aw*ah, areaB += aw*bh+bw*ah, areaC += bw*bh;
+            if (aw > 0)
+                sideBound = std::min(sideBound, ((allowRotation ? maxSide : width+spacing)-bw)/aw);
+            if (ah > 0)
+                sideBound = std::min(sideBound, ((allowRotation ? maxSide : height+spacing)-bh)/ah);
+        }
+        if (!(areaA > 0))
+            return false;
+        // Scales at which the total box area equals the atlas area and the fraction of it that is expected to be usable
+        upperBound = std::min((-areaB+sqrt(areaB*areaB-4*areaA*(areaC-atlasArea)))/(2*areaA), sideBound);
+        lowerBound = std::min((-areaB+sqrt(areaB*areaB-4*areaA*(areaC-PACKING_EFFICIENCY_ESTIMATE*atlasArea)))/(2*areaA), upperBound);
+        if (!(lowerBound > 0 && upperBound > 0))
+            return false;
+        s0 = lowerBound, s1 = std::max(upperBound, 1.25*lowerBound);
     }
-    if (minScale == maxScale)
-        return 0;
-    while (minScale/maxScale < 1-scaleMaximizationTolerance) {
-        double midScale = .5*(minScale+maxScale);
-        if (TRY_PACK(midScale))
-            minScale = midScale;
-        else
-            maxScale = midScale;
+    return true;
+}
+
+double TightAtlasPacker::packAndScale(GlyphGeometry *glyphs, int count, Rectangle &hotRegion, double &partitionArea, bool shelves) {
+    int w = width, h = height;
+    // A hint is expected to be close to the result, so the search starts from it with a small step, otherwise from the analytic bracket
+    double seed = 1, initialRatio = 2;
+    if (scaleHint > 0)
+        seed = scaleHint, initialRatio = 1+4*scaleMaximizationTolerance;
+    else {
+        double lowerBound, upperBound;
+        if (estimateScaleBounds(glyphs, count, w, h, lowerBound, upperBound))
+            seed = lowerBound, initialRatio = upperBound/lowerBound;
     }
-    if (!lastResult)
-        TRY_PACK(minScale);
-    return minScale;
+    return maximizeScale([this, glyphs, count, &w, &h, &hotRegion, &partitionArea, shelves](double scale) -> bool {
+        ++packAttempts;
+        return !tryPack(glyphs, count, DimensionsConstraint(), w, h, scale, hotRegion, partitionArea, shelves);
+    }, seed, initialRatio, scaleMaximizationTolerance, cancellationToken);
 }
 
 int TightAtlasPacker::pack(GlyphGeometry *glyphs, int count) {
+    // Large glyph sets are searched with the shelf packer, which is repeated for every candidate size and scale
+    bool shelves = fastPacking || count >= SHELF_SEARCH_THRESHOLD;
     double initialScale = scale > 0 ? scale : minScale;
+    packAttempts = 0;
     if (initialScale > 0) {
-        if (int remaining = tryPack(glyphs, count, dimensionsConstraint, width, height, initialScale))
+        ++packAttempts;
+        if (int remaining = tryPack(glyphs, count, dimensionsConstraint, width, height, initialScale, hotRegion, partitionArea, shelves))
             return remaining;
     } else if (width < 0 || height < 0)
         return -1;
     if (scale <= 0)
-        scale = packAndScale(glyphs, count);
-    if (scale <= 0)
+        scale = packAndScale(glyphs, count, hotRegion, partitionArea, shelves);
+    if (scale <= 0 || isCancelled(cancellationToken))
         return -1;
+    // Once the scale and dimensions are final, the layout is refined by the guillotine packer if it fits as well
+    if (shelves && !fastPacking) {
+        Rectangle refinedHotRegion;
+        double refinedPartitionArea;
+        ++packAttempts;
+        if (!tryPack(glyphs, count, DimensionsConstraint(), width, height, scale, refinedHotRegion, refinedPartitionArea, false))
+            hotRegion = refinedHotRegion, partitionArea = refinedPartitionArea;
+        else {
+            // The failed attempt has rewrapped the boxes (clearing rotation) - restore the shelf layout, which is deterministic
+            ++packAttempts;
+            if (tryPack(glyphs, count, DimensionsConstraint(), width, height, scale, hotRegion, partitionArea, true))
+                return -1;
+        }
+    }
+    glyphArea = 0;
+    for (const GlyphGeometry *glyph = glyphs, *end = glyphs+count; glyph < end; ++glyph) {
+        int w, h;
+        glyph->getBoxSize(w, h);
+        if (!glyph->isWhitespace())
+            glyphArea += (double) w*h;
+    }
     return 0;
 }
 
@@ -138,6 +419,19 @@ void TightAtlasPacker::setDimensionsConstraint(DimensionsConstraint dimensionsCo
     this->dimensionsConstraint = dimensionsConstraint;
 }
 
+void TightAtlasPacker::setMaximumDimensions(int maxWidth, int maxHeight) {
+    this->maxWidth = maxWidth;
+    this->maxHeight = maxHeight;
+}
+
+void TightAtlasPacker::setMemoryModel(const GpuMemoryModel &memoryModel) {
+    this->memoryModel = memoryModel;
+}
+
+void TightAtlasPacker::setScaleHint(double scaleHint) {
+    this->scaleHint = scaleHint;
+}
+
 void TightAtlasPacker::setSpacing(int spacing) {
     this->spacing = spacing;
 }
@@ -186,6 +480,38 @@ void TightAtlasPacker::setOuterPixelPadding(const Padding &padding) {
     outerPxPadding = padding;
 }
 
+void TightAtlasPacker::setGlyphWeights(const double *weights, int count, double hotCoverage) {
+    if (weights)
+        glyphWeights.assign(weights, weights+count);
+    else
+        glyphWeights.clear();
+    this->hotCoverage = hotCoverage;
+}
+
+void TightAtlasPacker::setHeuristicPortfolio(bool enabled) {
+    heuristicPortfolio = enabled;
+}
+
+void TightAtlasPacker::setFastPacking(bool fast) {
+    fastPacking = fast;
+}
+
+void TightAtlasPacker::setPartitionCount(int partitionCount) {
+    this->partitionCount = partitionCount;
+}
+
+void TightAtlasPacker::setRotationAllowed(bool allow) {
+    allowRotation = allow;
+}
+
+void TightAtlasPacker::setThreadCount(int threadCount) {
+    this->threadCount = threadCount;
+}
+
+void TightAtlasPacker::setCancellationToken(const CancellationToken *cancellationToken) {
+    this->cancellationToken = cancellationToken;
+}
+
 void TightAtlasPacker::getDimensions(int &width, int &height) const {
     width = this->width, height = this->height;
 }
@@ -198,4 +524,16 @@ msdfgen::Range TightAtlasPacker::getPixelRange() const {
     return pxRange+scale*unitRange;
 }
 
+Rectangle TightAtlasPacker::getHotRegion() const {
+    return hotRegion;
+}
+
+void TightAtlasPacker::getAreaStatistics(double &glyphArea, double &partitionArea) const {
+    glyphArea = this->glyphArea, partitionArea = this->partitionArea;
+}
+
+int TightAtlasPacker::getPackAttemptCount() const {
+    return packAttempts;
+}
+
 }
@@ -1,9 +1,13 @@
 
 #pragma once
 
+#include <vector>
 #include "types.h"
+#include "Rectangle.h"
 #include "Padding.h"
 #include "GlyphGeometry.h"
+#include "CancellationToken.h"
+#include "gpu-memory-model.h"
 
 namespace msdf_atlas {
 
@@ -23,14 +27,20 @@ public:
     void setDimensions(int width, int height);
     /// Sets the atlas's dimensions to be determined during pack
     void unsetDimensions();
-    /// Sets the constraint to be used when determining dimensions
+    /// Sets the constraint to be used when determining dimensions - with DimensionsConstraint::NONE, the dimensions of minimum area are searched over multiple aspect ratios
     void setDimensionsConstraint(DimensionsConstraint dimensionsConstraint);
+    /// Sets the maximum dimensions for DimensionsConstraint::NONE and MINIMUM_MEMORY (0 = unlimited)
+    void setMaximumDimensions(int maxWidth, int maxHeight);
+    /// Sets the model of GPU memory minimized by DimensionsConstraint::MINIMUM_MEMORY - the dimensions are then enlarged to fill the modeled allocation
+    void setMemoryModel(const GpuMemoryModel &memoryModel);
     /// Sets the spacing between glyph boxes
     void setSpacing(int spacing);
     /// Sets fixed glyph scale
     void setScale(double scale);
     /// Sets the minimum glyph scale
     void setMinimumScale(double minScale);
+    /// Sets an expected glyph scale (e.g. the result of a previous run), from which the scale search starts instead of the analytic estimate
+    void setScaleHint(double scaleHint);
     /// Sets the unit component of the total distance range
     void setUnitRange(msdfgen::Range unitRange);
     /// Sets the pixel component of the total distance range
@@ -48,6 +58,21 @@ public:
     void setInnerPixelPadding(const Padding &padding);
     /// Sets the pixel component of width of additional padding around each glyph quad
     void setOuterPixelPadding(const Padding &padding);
+    /// Sets usage weights of the glyphs (in the order they will be passed to pack) - the most used glyphs which together account for hotCoverage of the total weight are packed into a compact region of the atlas
+    void setGlyphWeights(const double *weights, int count, double hotCoverage);
+    /// Sets whether a portfolio of rectangle orders and fit rules should be tried for each candidate size, keeping the one with the smallest dimensions
+    void setHeuristicPortfolio(bool enabled);
+    /// Sets whether rectangles should be packed on shelves, which is much faster but less tight, for very large glyph sets.
+    /// Otherwise, the shelf packer is only used to search for the scale and dimensions of at least 16384 glyphs and the final layout is refined
+    void setFastPacking(bool fast);
+    /// Sets the number of partitions of glyphs of similar height, which are packed into separate regions in parallel before the regions are packed into the atlas (0 or 1 = flat packing)
+    void setPartitionCount(int partitionCount);
+    /// Sets whether glyph boxes may be rotated 90 degrees clockwise in the atlas to pack more tightly (see GlyphGeometry::isBoxRotated)
+    void setRotationAllowed(bool allow);
+    /// Sets the number of threads the heuristic portfolio and partitions are packed on
+    void setThreadCount(int threadCount);
+    /// Sets a token which interrupts the search for scale and dimensions when cancelled (pack then fails)
+    void setCancellationToken(const CancellationToken *cancellationToken);
 
     /// Outputs the atlas's final dimensions
     void getDimensions(int &width, int &height) const;
@@ -55,11 +80,19 @@ public:
     double getScale() const;
     /// Returns the final combined pixel range (including converted unit range)
     msdfgen::Range getPixelRange() const;
+    /// Returns the region of the atlas (with bottom-up Y) containing the most used glyphs, or an empty rectangle if glyph weights were not set
+    Rectangle getHotRegion() const;
+    /// Outputs the total area of the glyph boxes and of the partition regions they were packed into (0 if packed flat)
+    void getAreaStatistics(double &glyphArea, double &partitionArea) const;
+    /// Returns the number of times the glyphs were packed during the last pack, including the scale search
+    int getPackAttemptCount() const;
 
 private:
     int width, height;
     int spacing;
     DimensionsConstraint dimensionsConstraint;
+    int maxWidth, maxHeight;
+    GpuMemoryModel memoryModel;
     double scale;
     double minScale;
     msdfgen::Range unitRange;
@@ -68,10 +101,31 @@ private:
     bool pxAlignOriginX, pxAlignOriginY;
     Padding innerUnitPadding, outerUnitPadding;
     Padding innerPxPadding, outerPxPadding;
+    double scaleHint;
     double scaleMaximizationTolerance;
+    std::vector<double> glyphWeights;
+    double hotCoverage;
+    Rectangle hotRegion;
+    const CancellationToken *cancellationToken;
+    double glyphArea, partitionArea;
+    int packAttempts;
+    bool heuristicPortfolio;
+    bool fastPacking;
+    int partitionCount;
+    bool allowRotation;
+    int threadCount;
 
-    int tryPack(GlyphGeometry *glyphs, int count, DimensionsConstraint dimensionsConstraint, int &width, int &height, double scale) const;
-    double packAndScale(GlyphGeometry *glyphs, int count) const;
+    int tryPack(GlyphGeometry *glyphs, int count, DimensionsConstraint dimensionsConstraint, int &width, int &height, double scale, Rectangle &hotRegion, double &partitionArea, bool shelves) const;
+    void expandToAllocation(int &width, int &height) const;
+    template <typename RectangleType>
+    int packRectangleArray(RectangleType *rectangles, int count, DimensionsConstraint dimensionsConstraint, int &width, int &height, bool shelves) const;
+    template <typename RectangleType>
+    int packPartitioned(RectangleType *rectangles, int count, DimensionsConstraint dimensionsConstraint, int &width, int &height, double &partitionArea, bool shelves) const;
+    template <typename RectangleType>
+    int packBoxes(RectangleType *rectangles, int count, int hotCount, DimensionsConstraint dimensionsConstraint, int &width, int &height, Rectangle &hotRegion, double &partitionArea, bool shelves) const;
+    GlyphGeometry::GlyphAttributes glyphAttributes(double scale) const;
+    bool estimateScaleBounds(GlyphGeometry *glyphs, int count, int width, int height, double &lowerBound, double &upperBound) const;
+    double packAndScale(GlyphGeometry *glyphs, int count, Rectangle &hotRegion, double &partitionArea, bool shelves);
 
 };
 
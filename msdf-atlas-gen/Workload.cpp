@@ -1,50 +1,55 @@
 
 #include "Workload.h"
 
-#include <vector>
-#include <thread>
-#include <atomic>
-#include <algorithm>
-
 namespace msdf_atlas {
 
-Workload::Workload() : chunks(0) { }
+Workload::ProgressTracker::ProgressTracker(const ProgressCallback &callback, int total) : callback(callback), total(total), completed(0), start(std::chrono::steady_clock::now()) { }
+
+void Workload::ProgressTracker::chunksFinished(int count) {
+    if (callback) {
+        std::lock_guard<std::mutex> lock(mutex);
+        completed += count;
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+        callback(completed, total, completed < total ? elapsed/completed*(total-completed) : 0);
+    }
+}
+
+Workload::Workload() : chunks(0), cancellationToken(nullptr), grainSize(0), pinThreads(false), numaAffinity(false) { }
+
+Workload::Workload(int chunks) : chunks(chunks), cancellationToken(nullptr), grainSize(0), pinThreads(false), numaAffinity(false) { }
+
+Workload::Workload(const std::function<bool(int, int)> &workerFunction, int chunks) : workerFunction(workerFunction), chunks(chunks), cancellationToken(nullptr), grainSize(0), pinThreads(false), numaAffinity(false) { }
 
-Workload::Workload(const std::function<bool(int, int)> &workerFunction, int chunks) : workerFunction(workerFunction), chunks(chunks) { }
+Workload &Workload::setCancellationToken(const CancellationToken *cancellationToken) {
+    this->cancellationToken = cancellationToken;
+    return *this;
+}
+
+Workload &Workload::setProgressCallback(const ProgressCallback &progressCallback) {
+    this->progressCallback = progressCallback;
+    return *this;
+}
+
+Workload &Workload::setGrainSize(int grainSize) {
+    this->grainSize = grainSize;
+    return *this;
+}
 
-bool Workload::finishSequential() {
-    for (int i = 0; i < chunks; ++i)
-        if (!workerFunction(i, 0))
-            return false;
-    return true;
+Workload &Workload::setThreadPinning(bool pinThreads) {
+    this->pinThreads = pinThreads;
+    return *this;
 }
 
-bool Workload::finishParallel(int threadCount) {
-    bool result = true;
-    std::atomic<int> next(0);
-    std::function<void(int)> threadWorker = [this, &result, &next](int threadNo) {
-        for (int i = next++; result && i < chunks; i = next++) {
-            if (!workerFunction(i, threadNo))
-                result = false;
-        }
-    };
-    std::vector<std::thread> threads;
-    threads.reserve(threadCount);
-    for (int i = 0; i < threadCount; ++i)
-        threads.emplace_back(threadWorker, i);
-    for (std::thread &thread : threads)
-        thread.join();
-    return result;
+Workload &Workload::setNumaAffinity(bool numaAffinity) {
+    this->numaAffinity = numaAffinity;
+    return *this;
 }
 
 bool Workload::finish(int threadCount) {
-    if (!chunks)
-        return true;
-    if (threadCount == 1 || chunks == 1)
-        return finishSequential();
-    if (threadCount > 1)
-        return finishParallel(std::min(threadCount, chunks));
-    return false;
+    // Without a worker function (constructed from the chunk count only), only an empty workload can be finished
+    if (!workerFunction)
+        return chunks <= 0;
+    return finish(workerFunction, threadCount);
 }
 
 }
@@ -2,31 +2,73 @@
 #pragma once
 
 #include <functional>
+#include <mutex>
+#include <chrono>
+#include "CancellationToken.h"
 
 namespace msdf_atlas {
 
+/// Receives the number of finished chunks out of the total and the estimated remaining time in seconds (negative if unknown)
+typedef std::function<void(int completedChunks, int totalChunks, double remainingSeconds)> ProgressCallback;
+
 /**
  * This function allows to split a workload into multiple threads.
  * The worker function:
  *     bool FN(int chunk, int threadNo);
  * should process the given chunk (out of chunks) and return true.
- * If false is returned, the process is interrupted.
+ * If false is returned, or the cancellation token is cancelled, the process is interrupted
+ * (chunks already being processed are finished first).
+ * Threads claim contiguous blocks of chunks, by default of decreasing size (a fraction of the chunks left),
+ * so that short chunks do not contend on the shared counter while the load remains balanced at the end.
  */
 class Workload {
 
 public:
     Workload();
+    explicit Workload(int chunks);
     Workload(const std::function<bool(int, int)> &workerFunction, int chunks);
-    /// Runs the process and returns true if all chunks have been processed
+    /// Sets a token which interrupts the process when cancelled
+    Workload &setCancellationToken(const CancellationToken *cancellationToken);
+    /// Sets a function to be called after each finished block of chunks (calls are serialized but may come from any of the threads)
+    Workload &setProgressCallback(const ProgressCallback &progressCallback);
+    /// Sets a fixed number of chunks claimed by a thread at once (0 = adaptive)
+    Workload &setGrainSize(int grainSize);
+    /// Sets whether each thread should be pinned to a different allowed CPU (only if more than one thread is used)
+    Workload &setThreadPinning(bool pinThreads);
+    /// Sets whether threads should be split into groups pinned to the NUMA nodes, each group first processing
+    /// its own contiguous range of chunks (the i-th of getNumaNodeCount equal parts) before helping the others
+    Workload &setNumaAffinity(bool numaAffinity);
+    /// Runs the process with the worker function passed to the constructor and returns true if all chunks have been processed
+    /// (returns false if there is no worker function and at least one chunk)
     bool finish(int threadCount);
+    /// Runs the process with the given worker function of any callable type, which avoids the indirection of std::function
+    template <typename FN>
+    bool finish(const FN &workerFunction, int threadCount) const;
 
 private:
+    /// Reports progress to the callback, serialized between threads
+    class ProgressTracker {
+    public:
+        ProgressTracker(const ProgressCallback &callback, int total);
+        void chunksFinished(int count);
+    private:
+        const ProgressCallback &callback;
+        int total;
+        int completed;
+        std::chrono::steady_clock::time_point start;
+        std::mutex mutex;
+    };
+
     std::function<bool(int, int)> workerFunction;
     int chunks;
-
-    bool finishSequential();
-    bool finishParallel(int threadCount);
+    const CancellationToken *cancellationToken;
+    ProgressCallback progressCallback;
+    int grainSize;
+    bool pinThreads;
+    bool numaAffinity;
 
 };
 
 }
+
+#include "Workload.hpp"
@@ -0,0 +1,83 @@
+
+#include "Workload.h"
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include "cpu-topology.h"
+
+namespace msdf_atlas {
+
+template <typename FN>
+bool Workload::finish(const FN &workerFunction, int threadCount) const {
+    if (!chunks)
+        return true;
+    if (chunks == 1)
+        threadCount = 1;
+    if (threadCount < 1)
+        return false;
+    threadCount = std::min(threadCount, chunks);
+    // With NUMA affinity, threads form a group per node, and each group first processes its own contiguous range of chunks
+    int groupCount = numaAffinity ? std::min(getNumaNodeCount(), threadCount) : 1;
+    std::vector<int> groupEnds(groupCount);
+    std::unique_ptr<std::atomic<int>[]> groupNext(new std::atomic<int>[groupCount]);
+    for (int i = 0; i < groupCount; ++i) {
+        groupNext[i].store(i == 0 ? 0 : groupEnds[i-1], std::memory_order_relaxed);
+        groupEnds[i] = (int) ((long long) chunks*(i+1)/groupCount);
+    }
+    std::atomic<bool> result(true);
+    ProgressTracker progress(progressCallback, chunks);
+    auto threadWorker = [&](int threadNo) {
+        int group = threadNo*groupCount/threadCount;
+        int groupThreadCount = std::max(threadCount/groupCount, 1);
+        if (threadCount > 1) {
+            if (numaAffinity)
+                pinCurrentThreadToNumaNode(group);
+            else if (pinThreads)
+                pinCurrentThread(threadNo);
+        }
+        // After the group's own range is finished, help with the ranges of other groups
+        for (int k = 0; k < groupCount; ++k) {
+            int range = (group+k)%groupCount;
+            std::atomic<int> &next = groupNext[range];
+            int rangeEnd = groupEnds[range];
+            while (result.load(std::memory_order_relaxed)) {
+                // Guided scheduling - claim a fraction of the remaining chunks, at least one
+                int grain = grainSize;
+                if (grain <= 0)
+                    grain = std::max((rangeEnd-next.load(std::memory_order_relaxed))/(4*groupThreadCount), 1);
+                int begin = next.fetch_add(grain, std::memory_order_relaxed);
+                if (begin >= rangeEnd)
+                    break;
+                int end = std::min(begin+grain, rangeEnd);
+                for (int i = begin; i < end; ++i) {
+                    if (isCancelled(cancellationToken) || !workerFunction(i, threadNo)) {
+                        result.store(false, std::memory_order_relaxed);
+                        return;
+                    }
+                }
+                progress.chunksFinished(end-begin);
+            }
+        }
+    };
+    if (threadCount == 1) {
+        threadWorker(0);
+        return result;
+    }
+    // The calling thread acts as the first worker, unless threads are pinned, which would leave it pinned afterwards
+    bool pinned = pinThreads || numaAffinity;
+    int firstSpawned = pinned ? 0 : 1;
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount-firstSpawned);
+    for (int i = firstSpawned; i < threadCount; ++i)
+        threads.emplace_back(threadWorker, i);
+    if (!pinned)
+        threadWorker(0);
+    for (std::thread &thread : threads)
+        thread.join();
+    return result;
+}
+
+}
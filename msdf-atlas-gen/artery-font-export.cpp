@@ -3,6 +3,7 @@
 
 #ifndef MSDF_ATLAS_NO_ARTERY_FONT
 
+#include <string>
 #include <artery-font/std-artery-font.h>
 #include <artery-font/stdio-serialization.h>
 #include "GlyphGeometry.h"
@@ -60,8 +61,13 @@ bool exportArteryFont(const FontGeometry *fonts, int fontCount, const msdfgen::B
     artery_font::StdArteryFont<REAL> arfont = { };
     arfont.metadataFormat = artery_font::METADATA_NONE;
 
+    // The format has no per-glyph orientation, so identifiers of glyphs rotated in the atlas are listed in JSON metadata instead
+    std::string rotatedGlyphs;
+    bool anyRotated = false;
+
     arfont.variants = artery_font::StdList<typename artery_font::StdArteryFont<REAL>::Variant>(fontCount);
     for (int i = 0; i < fontCount; ++i) {
+        rotatedGlyphs += i ? ",[" : "[";
         const FontGeometry &font = fonts[i];
         GlyphIdentifierType identifierType = font.getPreferredIdentifierType();
         const msdfgen::FontMetrics &fontMetrics = font.getMetrics();
@@ -101,7 +107,14 @@ bool exportArteryFont(const FontGeometry *fonts, int fontCount, const msdfgen::B
             glyph.imageBounds.t = REAL(t);
             glyph.advance.h = REAL(glyphGeom.getAdvance());
             glyph.advance.v = REAL(0);
+            if (glyphGeom.isBoxRotated()) {
+                if (rotatedGlyphs.back() != '[')
+                    rotatedGlyphs.push_back(',');
+                rotatedGlyphs += std::to_string(glyph.codepoint);
+                anyRotated = true;
+            }
         }
+        rotatedGlyphs.push_back(']');
         switch (identifierType) {
             case GlyphIdentifierType::GLYPH_INDEX:
                 for (const std::pair<std::pair<int, int>, double> &elem : font.getKerning()) {
@@ -128,6 +141,11 @@ bool exportArteryFont(const FontGeometry *fonts, int fontCount, const msdfgen::B
         }
     }
 
+    if (anyRotated) {
+        arfont.metadataFormat = artery_font::METADATA_JSON;
+        (std::string &) arfont.metadata = "{\"rotatedGlyphs\":["+rotatedGlyphs+"]}";
+    }
+
     arfont.images = artery_font::StdList<typename artery_font::StdArteryFont<REAL>::Image>(1);
     {
         typename artery_font::StdArteryFont<REAL>::Image &image = arfont.images[0] = typename artery_font::StdArteryFont<REAL>::Image();
@@ -0,0 +1,156 @@
+
+#include "artery-font-import.h"
+
+#ifndef MSDF_ATLAS_NO_ARTERY_FONT
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <artery-font/std-artery-font.h>
+#include <artery-font/stdio-serialization.h>
+#include <core/pixel-conversion.hpp>
+#include "image-decode.h"
+
+namespace msdf_atlas {
+
+typedef artery_font::StdArteryFont<float> ArteryFont;
+
+template <typename T>
+static artery_font::PixelFormat getPixelFormat();
+
+template <>
+artery_font::PixelFormat getPixelFormat<byte>() {
+    return artery_font::PIXEL_UNSIGNED8;
+}
+template <>
+artery_font::PixelFormat getPixelFormat<float>() {
+    return artery_font::PIXEL_FLOAT32;
+}
+
+template <int N>
+static void assignPixels(msdfgen::Bitmap<byte, N> &output, msdfgen::Bitmap<byte, N> &&input) {
+    output = (msdfgen::Bitmap<byte, N> &&) input;
+}
+
+template <int N>
+static void assignPixels(msdfgen::Bitmap<float, N> &output, msdfgen::Bitmap<byte, N> &&input) {
+    msdfgen::Bitmap<float, N> converted(input.width(), input.height());
+    const byte *src = input;
+    float *dst = converted;
+    for (int i = 0; i < N*input.width()*input.height(); ++i)
+        dst[i] = msdfgen::pixelByteToFloat(src[i]);
+    output = (msdfgen::Bitmap<float, N> &&) converted;
+}
+
+template <typename T, int N>
+static bool decodeImage(msdfgen::Bitmap<T, N> &output, ArteryFont::Image &image) {
+    if (image.channels != N)
+        return false;
+    std::vector<byte> &data = (std::vector<byte> &) image.data;
+    switch (image.encoding) {
+    #ifndef MSDFGEN_DISABLE_PNG
+        case artery_font::IMAGE_PNG: {
+            msdfgen::Bitmap<byte, N> bitmap;
+            if (!decodePng(bitmap, data.data(), data.size()))
+                return false;
+            assignPixels(output, (msdfgen::Bitmap<byte, N> &&) bitmap);
+            return true;
+        }
+    #endif
+        case artery_font::IMAGE_RAW_BINARY: {
+            int rowLength = N*sizeof(T)*image.width;
+            if (image.pixelFormat != getPixelFormat<T>() || (int) image.rawBinaryFormat.rowLength < rowLength || data.size() < (size_t) image.rawBinaryFormat.rowLength*image.height)
+                return false;
+            msdfgen::Bitmap<T, N> bitmap(image.width, image.height);
+            for (int y = 0; y < (int) image.height; ++y) {
+                int row = image.rawBinaryFormat.orientation == artery_font::ORIENTATION_TOP_DOWN ? image.height-y-1 : y;
+                memcpy(bitmap(0, row), data.data()+image.rawBinaryFormat.rowLength*y, rowLength);
+            }
+            output = (msdfgen::Bitmap<T, N> &&) bitmap;
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+/// Reads the identifiers of glyphs rotated in the atlas, listed per variant in the JSON metadata written by exportArteryFont
+static void parseRotatedGlyphs(std::vector<std::vector<unsigned> > &rotatedGlyphs, const ArteryFont &arfont) {
+    if (arfont.metadataFormat != artery_font::METADATA_JSON)
+        return;
+    const std::string &metadata = (const std::string &) arfont.metadata;
+    size_t pos = metadata.find("\"rotatedGlyphs\"");
+    if (pos == std::string::npos || (pos = metadata.find('[', pos)) == std::string::npos)
+        return;
+    const char *cur = metadata.c_str()+pos+1;
+    for (size_t variant = 0; variant < rotatedGlyphs.size(); ++variant) {
+        while (*cur == ' ' || *cur == ',')
+            ++cur;
+        if (*cur++ != '[')
+            return;
+        while (*cur && *cur != ']') {
+            char *end;
+            unsigned long codepoint = strtoul(cur, &end, 10);
+            if (end == cur)
+                return;
+            rotatedGlyphs[variant].push_back((unsigned) codepoint);
+            cur = end;
+            while (*cur == ' ' || *cur == ',')
+                ++cur;
+        }
+        if (*cur++ != ']')
+            return;
+        std::sort(rotatedGlyphs[variant].begin(), rotatedGlyphs[variant].end());
+    }
+}
+
+template <typename T, int N>
+int importArteryFont(msdfgen::Bitmap<T, N> &atlas, GlyphGeometry *glyphs, const FontGeometry *fonts, int fontCount, const char *filename) {
+    ArteryFont arfont;
+    if (!artery_font::readFile(arfont, filename))
+        return -1;
+    std::vector<ArteryFont::Variant> &variants = (std::vector<ArteryFont::Variant> &) arfont.variants;
+    std::vector<ArteryFont::Image> &images = (std::vector<ArteryFont::Image> &) arfont.images;
+    if ((int) variants.size() != fontCount || images.empty() || !decodeImage(atlas, images[0]))
+        return -1;
+
+    std::vector<std::vector<unsigned> > rotatedGlyphs(fontCount);
+    parseRotatedGlyphs(rotatedGlyphs, arfont);
+
+    int unplaced = 0;
+    for (int i = 0; i < fontCount; ++i) {
+        const FontGeometry &font = fonts[i];
+        std::vector<bool> placed(font.getGlyphs().size());
+        const GlyphGeometry *firstGlyph = font.getGlyphs().begin();
+        for (const artery_font::Glyph<float> &arGlyph : (std::vector<artery_font::Glyph<float> > &) variants[i].glyphs) {
+            const GlyphGeometry *glyph = nullptr;
+            switch (variants[i].codepointType) {
+                case artery_font::CP_INDEXED:
+                    glyph = font.getGlyph(msdfgen::GlyphIndex(arGlyph.codepoint));
+                    break;
+                default:
+                    glyph = font.getGlyph((unicode_t) arGlyph.codepoint);
+            }
+            // Atlas bounds are always stored bottom-up, image orientation only affects the pixel data
+            bool rotated = std::binary_search(rotatedGlyphs[i].begin(), rotatedGlyphs[i].end(), (unsigned) arGlyph.codepoint);
+            if (glyph && glyphs[glyph-glyphs].placeBoxAtQuadAtlasBounds(arGlyph.imageBounds.l, arGlyph.imageBounds.b, arGlyph.imageBounds.r, arGlyph.imageBounds.t, rotated))
+                placed[glyph-firstGlyph] = true;
+        }
+        for (bool glyphPlaced : placed)
+            unplaced += !glyphPlaced;
+    }
+    return unplaced;
+}
+
+template int importArteryFont(msdfgen::Bitmap<byte, 1> &atlas, GlyphGeometry *glyphs, const FontGeometry *fonts, int fontCount, const char *filename);
+template int importArteryFont(msdfgen::Bitmap<byte, 3> &atlas, GlyphGeometry *glyphs, const FontGeometry *fonts, int fontCount, const char *filename);
+template int importArteryFont(msdfgen::Bitmap<byte, 4> &atlas, GlyphGeometry *glyphs, const FontGeometry *fonts, int fontCount, const char *filename);
+template int importArteryFont(msdfgen::Bitmap<float, 1> &atlas, GlyphGeometry *glyphs, const FontGeometry *fonts, int fontCount, const char *filename);
+template int importArteryFont(msdfgen::Bitmap<float, 3> &atlas, GlyphGeometry *glyphs, const FontGeometry *fonts, int fontCount, const char *filename);
+template int importArteryFont(msdfgen::Bitmap<float, 4> &atlas, GlyphGeometry *glyphs, const FontGeometry *fonts, int fontCount, const char *filename);
+
+}
+
+#endif
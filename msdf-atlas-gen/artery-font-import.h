@@ -0,0 +1,23 @@
+
+#pragma once
+
+#ifndef MSDF_ATLAS_NO_ARTERY_FONT
+
+#include <msdfgen.h>
+#include "types.h"
+#include "GlyphGeometry.h"
+#include "FontGeometry.h"
+
+namespace msdf_atlas {
+
+/**
+ * Decodes the atlas bitmap of a prebuilt Artery Atlas Font file and places glyphs as described by its layout.
+ * The glyphs of the fonts must be stored in the glyphs array and already wrapped with the attributes the atlas was built with.
+ * Returns the number of glyphs that could not be placed (0 on success) or -1 if the file or its atlas image could not be read.
+ */
+template <typename T, int N>
+int importArteryFont(msdfgen::Bitmap<T, N> &atlas, GlyphGeometry *glyphs, const FontGeometry *fonts, int fontCount, const char *filename);
+
+}
+
+#endif
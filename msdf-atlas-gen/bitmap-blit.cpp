@@ -3,6 +3,7 @@
 
 #include <cstring>
 #include <algorithm>
+#include "simd-kernels.h"
 
 namespace msdf_atlas {
 
@@ -31,42 +32,35 @@ BLIT_SAME_TYPE_IMPL(float, 1)
 BLIT_SAME_TYPE_IMPL(float, 3)
 BLIT_SAME_TYPE_IMPL(float, 4)
 
-void blit(const msdfgen::BitmapRef<byte, 1> &dst, const msdfgen::BitmapConstRef<float, 1> &src, int dx, int dy, int sx, int sy, int w, int h) {
+template <int N>
+void blitFloatToByte(const msdfgen::BitmapRef<byte, N> &dst, const msdfgen::BitmapConstRef<float, N> &src, int dx, int dy, int sx, int sy, int w, int h) {
     BOUND_AREA();
-    for (int y = 0; y < h; ++y) {
-        byte *dstPixel = dst(dx, dy+y);
-        for (int x = 0; x < w; ++x) {
-            const float *srcPixel = src(sx+x, sy+y);
-            *dstPixel++ = msdfgen::pixelFloatToByte(*srcPixel);
-        }
-    }
+    for (int y = 0; y < h; ++y)
+        convertFloatToByte(dst(dx, dy+y), src(sx, sy+y), (size_t) N*w);
 }
 
-void blit(const msdfgen::BitmapRef<byte, 3> &dst, const msdfgen::BitmapConstRef<float, 3> &src, int dx, int dy, int sx, int sy, int w, int h) {
-    BOUND_AREA();
-    for (int y = 0; y < h; ++y) {
-        byte *dstPixel = dst(dx, dy+y);
-        for (int x = 0; x < w; ++x) {
-            const float *srcPixel = src(sx+x, sy+y);
-            *dstPixel++ = msdfgen::pixelFloatToByte(srcPixel[0]);
-            *dstPixel++ = msdfgen::pixelFloatToByte(srcPixel[1]);
-            *dstPixel++ = msdfgen::pixelFloatToByte(srcPixel[2]);
-        }
-    }
-}
+#define BLIT_FLOAT_TO_BYTE_IMPL(N) void blit(const msdfgen::BitmapRef<byte, N> &dst, const msdfgen::BitmapConstRef<float, N> &src, int dx, int dy, int sx, int sy, int w, int h) { blitFloatToByte(dst, src, dx, dy, sx, sy, w, h); }
 
-void blit(const msdfgen::BitmapRef<byte, 4> &dst, const msdfgen::BitmapConstRef<float, 4> &src, int dx, int dy, int sx, int sy, int w, int h) {
-    BOUND_AREA();
-    for (int y = 0; y < h; ++y) {
-        byte *dstPixel = dst(dx, dy+y);
-        for (int x = 0; x < w; ++x) {
-            const float *srcPixel = src(sx+x, sy+y);
-            *dstPixel++ = msdfgen::pixelFloatToByte(srcPixel[0]);
-            *dstPixel++ = msdfgen::pixelFloatToByte(srcPixel[1]);
-            *dstPixel++ = msdfgen::pixelFloatToByte(srcPixel[2]);
-            *dstPixel++ = msdfgen::pixelFloatToByte(srcPixel[3]);
-        }
+BLIT_FLOAT_TO_BYTE_IMPL(1)
+BLIT_FLOAT_TO_BYTE_IMPL(3)
+BLIT_FLOAT_TO_BYTE_IMPL(4)
+
+template <typename T, int N>
+void rotateClockwiseImpl(const msdfgen::BitmapRef<T, N> &dst, const msdfgen::BitmapConstRef<T, N> &src) {
+    // The top of the source faces right, so source row y becomes destination column y, with source x running downwards
+    for (int y = 0; y < src.height; ++y) {
+        for (int x = 0; x < src.width; ++x)
+            memcpy(dst(y, src.width-1-x), src(x, y), sizeof(T)*N);
     }
 }
 
+#define ROTATE_CLOCKWISE_IMPL(T, N) void rotateClockwise(const msdfgen::BitmapRef<T, N> &dst, const msdfgen::BitmapConstRef<T, N> &src) { rotateClockwiseImpl(dst, src); }
+
+ROTATE_CLOCKWISE_IMPL(byte, 1)
+ROTATE_CLOCKWISE_IMPL(byte, 3)
+ROTATE_CLOCKWISE_IMPL(byte, 4)
+ROTATE_CLOCKWISE_IMPL(float, 1)
+ROTATE_CLOCKWISE_IMPL(float, 3)
+ROTATE_CLOCKWISE_IMPL(float, 4)
+
 }
@@ -86,7 +86,7 @@ static bool readString(void *userData, std::string &str, char terminator) {
     }
 }
 
-template <int (READ_CHAR)(void *), void (ADD)(void *, unicode_t), bool (INCLUDE)(void *, const std::string &)>
+template <int (READ_CHAR)(void *), void (ADD)(void *, unicode_t), void (ADD_RANGE)(void *, unicode_t, unicode_t), bool (INCLUDE)(void *, const std::string &)>
 static bool charsetParse(void *userData, bool disableCharLiterals, bool disableInclude) {
 
     enum {
@@ -123,8 +123,8 @@ static bool charsetParse(void *userData, bool disableCharLiterals, bool disableI
                             state = RANGE_START;
                             break;
                         case RANGE_SEPARATOR:
-                            for (unicode_t u = rangeStart; (int) u <= cp; ++u)
-                                ADD(userData, u);
+                            if (cp >= 0)
+                                ADD_RANGE(userData, rangeStart, (unicode_t) cp);
                             state = RANGE_END;
                             break;
                         default:;
@@ -150,8 +150,7 @@ static bool charsetParse(void *userData, bool disableCharLiterals, bool disableI
                             state = RANGE_START;
                             break;
                         case RANGE_SEPARATOR:
-                            for (unicode_t u = rangeStart; u <= unicodeBuffer[0]; ++u)
-                                ADD(userData, u);
+                            ADD_RANGE(userData, rangeStart, unicodeBuffer[0]);
                             state = RANGE_END;
                             break;
                         default:;
@@ -241,18 +240,25 @@ static std::string combinePath(const char *basePath, const char *relPath) {
     return std::string(basePath, lastSlash+1)+relPath;
 }
 
+// Individual codepoints are collected and added to the charset at once, as they may come in any order
+
 struct CharsetLoadData {
     Charset *charset;
     const char *filename;
     bool disableCharLiterals;
     FILE *file;
+    std::vector<unicode_t> codepoints;
 
     static int readChar(void *userData) {
         return fgetc(reinterpret_cast<CharsetLoadData *>(userData)->file);
     }
 
     static void add(void *userData, unicode_t cp) {
-        reinterpret_cast<CharsetLoadData *>(userData)->charset->add(cp);
+        reinterpret_cast<CharsetLoadData *>(userData)->codepoints.push_back(cp);
+    }
+
+    static void addRange(void *userData, unicode_t first, unicode_t last) {
+        reinterpret_cast<CharsetLoadData *>(userData)->charset->addRange(first, last);
     }
 
     static bool include(void *userData, const std::string &path) {
@@ -264,8 +270,9 @@ struct CharsetLoadData {
 bool Charset::load(const char *filename, bool disableCharLiterals) {
     if (FILE *f = fopen(filename, "rb")) {
         CharsetLoadData userData = { this, filename, disableCharLiterals, f };
-        bool success = charsetParse<CharsetLoadData::readChar, CharsetLoadData::add, CharsetLoadData::include>(&userData, disableCharLiterals, false);
+        bool success = charsetParse<CharsetLoadData::readChar, CharsetLoadData::add, CharsetLoadData::addRange, CharsetLoadData::include>(&userData, disableCharLiterals, false);
         fclose(f);
+        add(userData.codepoints.data(), userData.codepoints.size());
         return success;
     }
     return false;
@@ -274,6 +281,7 @@ bool Charset::load(const char *filename, bool disableCharLiterals) {
 struct CharsetParseData {
     Charset *charset;
     const char *cur, *end;
+    std::vector<unicode_t> codepoints;
 
     static int readChar(void *userData) {
         CharsetParseData &ud = *reinterpret_cast<CharsetParseData *>(userData);
@@ -281,7 +289,11 @@ struct CharsetParseData {
     }
 
     static void add(void *userData, unicode_t cp) {
-        reinterpret_cast<CharsetParseData *>(userData)->charset->add(cp);
+        reinterpret_cast<CharsetParseData *>(userData)->codepoints.push_back(cp);
+    }
+
+    static void addRange(void *userData, unicode_t first, unicode_t last) {
+        reinterpret_cast<CharsetParseData *>(userData)->charset->addRange(first, last);
     }
 
     static bool include(void *, const std::string &) {
@@ -291,7 +303,9 @@ struct CharsetParseData {
 
 bool Charset::parse(const char *str, size_t strLength, bool disableCharLiterals) {
     CharsetParseData userData = { this, str, str+strLength };
-    return charsetParse<CharsetParseData::readChar, CharsetParseData::add, CharsetParseData::include>(&userData, disableCharLiterals, true);
+    bool success = charsetParse<CharsetParseData::readChar, CharsetParseData::add, CharsetParseData::addRange, CharsetParseData::include>(&userData, disableCharLiterals, true);
+    add(userData.codepoints.data(), userData.codepoints.size());
+    return success;
 }
 
 }
@@ -0,0 +1,221 @@
+
+#ifdef __linux__
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <sched.h>
+#endif
+
+#include "cpu-topology.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <thread>
+#include <algorithm>
+
+namespace msdf_atlas {
+
+#ifdef __linux__
+
+/// CPUs in the affinity mask of the process at the time of the first call, before any threads are pinned
+static const std::vector<int> &allowedCpus() {
+    static const std::vector<int> cpus = []() -> std::vector<int> {
+        std::vector<int> cpus;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (!sched_getaffinity(0, sizeof(set), &set)) {
+            for (int i = 0; i < CPU_SETSIZE; ++i)
+                if (CPU_ISSET(i, &set))
+                    cpus.push_back(i);
+        }
+        return cpus;
+    }();
+    return cpus;
+}
+
+/// Parses a CPU list such as "0-3,8-11" into a mask
+static void parseCpuList(std::vector<bool> &mask, const char *list) {
+    while (*list) {
+        char *end;
+        long first = strtol(list, &end, 10), last = first;
+        if (end == list)
+            break;
+        if (*end == '-') {
+            list = end+1;
+            last = strtol(list, &end, 10);
+        }
+        for (long i = first; i <= last && i >= 0 && i < CPU_SETSIZE; ++i) {
+            if (i >= (long) mask.size())
+                mask.resize(i+1);
+            mask[i] = true;
+        }
+        list = *end == ',' ? end+1 : end;
+        if (*end != ',')
+            break;
+    }
+}
+
+/// Allowed CPUs grouped by NUMA node, nodes without allowed CPUs are omitted
+static const std::vector<std::vector<int> > &numaNodeCpus() {
+    static const std::vector<std::vector<int> > nodes = []() -> std::vector<std::vector<int> > {
+        std::vector<std::vector<int> > nodes;
+        const std::vector<int> &cpus = allowedCpus();
+        std::vector<bool> assigned(cpus.size());
+        int missing = 0;
+        for (int node = 0; missing < 64; ++node) {
+            char filename[64];
+            sprintf(filename, "/sys/devices/system/node/node%d/cpulist", node);
+            char buffer[1024];
+            FILE *f = fopen(filename, "r");
+            if (!f) {
+                // Node numbers may be sparse
+                ++missing;
+                continue;
+            }
+            std::vector<bool> mask;
+            if (fgets(buffer, sizeof(buffer), f))
+                parseCpuList(mask, buffer);
+            fclose(f);
+            std::vector<int> nodeCpus;
+            for (size_t i = 0; i < cpus.size(); ++i) {
+                if (!assigned[i] && cpus[i] < (int) mask.size() && mask[cpus[i]]) {
+                    nodeCpus.push_back(cpus[i]);
+                    assigned[i] = true;
+                }
+            }
+            if (!nodeCpus.empty())
+                nodes.push_back((std::vector<int> &&) nodeCpus);
+        }
+        // CPUs not listed under any node (or no NUMA information) form one more group
+        std::vector<int> rest;
+        for (size_t i = 0; i < cpus.size(); ++i)
+            if (!assigned[i])
+                rest.push_back(cpus[i]);
+        if (!rest.empty())
+            nodes.push_back((std::vector<int> &&) rest);
+        return nodes;
+    }();
+    return nodes;
+}
+
+static bool readLine(const char *filename, std::string &line) {
+    if (FILE *f = fopen(filename, "r")) {
+        char buffer[256];
+        bool success = fgets(buffer, sizeof(buffer), f) != nullptr;
+        fclose(f);
+        if (success) {
+            line = buffer;
+            return true;
+        }
+    }
+    return false;
+}
+
+/// Returns the CPU quota of the process's cgroup as a (fractional) number of CPUs, or 0 if unlimited or unknown
+static double cgroupCpuQuota() {
+    std::string line;
+    // cgroup v2 - "<quota> <period>" or "max <period>" in cpu.max of the process's group (or the root of the namespace)
+    std::string groupPath;
+    if (FILE *f = fopen("/proc/self/cgroup", "r")) {
+        char buffer[1024];
+        while (fgets(buffer, sizeof(buffer), f)) {
+            if (!strncmp(buffer, "0::", 3)) {
+                groupPath = buffer+3;
+                groupPath.erase(groupPath.find_last_not_of("\r\n")+1);
+                break;
+            }
+        }
+        fclose(f);
+    }
+    std::string cpuMaxFiles[] = { "/sys/fs/cgroup"+groupPath+"/cpu.max", "/sys/fs/cgroup/cpu.max" };
+    for (const std::string &filename : cpuMaxFiles) {
+        if (readLine(filename.c_str(), line)) {
+            double quota, period;
+            if (sscanf(line.c_str(), "%lf %lf", &quota, &period) == 2 && quota > 0 && period > 0)
+                return quota/period;
+            return 0;
+        }
+    }
+    // cgroup v1 - quota of -1 means unlimited
+    const char *cpuGroupDirs[] = { "/sys/fs/cgroup/cpu", "/sys/fs/cgroup/cpu,cpuacct" };
+    for (const char *dir : cpuGroupDirs) {
+        std::string quotaLine, periodLine;
+        if (readLine((std::string(dir)+"/cpu.cfs_quota_us").c_str(), quotaLine) && readLine((std::string(dir)+"/cpu.cfs_period_us").c_str(), periodLine)) {
+            double quota = atof(quotaLine.c_str()), period = atof(periodLine.c_str());
+            if (quota > 0 && period > 0)
+                return quota/period;
+            return 0;
+        }
+    }
+    return 0;
+}
+
+int getAvailableCpuCount() {
+    int count = (int) allowedCpus().size();
+    if (count <= 0)
+        count = (int) std::thread::hardware_concurrency();
+    double quota = cgroupCpuQuota();
+    if (quota > 0)
+        count = count > 0 ? std::min(count, (int) ceil(quota)) : (int) ceil(quota);
+    return std::max(count, 1);
+}
+
+bool pinCurrentThread(int threadNo) {
+    const std::vector<int> &cpus = allowedCpus();
+    if (cpus.empty() || threadNo < 0)
+        return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpus[threadNo%cpus.size()], &set);
+    return !sched_setaffinity(0, sizeof(set), &set);
+}
+
+int getNumaNodeCount() {
+    return std::max((int) numaNodeCpus().size(), 1);
+}
+
+bool pinCurrentThreadToNumaNode(int node) {
+    const std::vector<std::vector<int> > &nodes = numaNodeCpus();
+    if (node < 0 || node >= (int) nodes.size())
+        return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : nodes[node])
+        CPU_SET(cpu, &set);
+    return !sched_setaffinity(0, sizeof(set), &set);
+}
+
+#else
+
+int getAvailableCpuCount() {
+    return std::max((int) std::thread::hardware_concurrency(), 1);
+}
+
+bool pinCurrentThread(int) {
+    return false;
+}
+
+int getNumaNodeCount() {
+    return 1;
+}
+
+bool pinCurrentThreadToNumaNode(int) {
+    return false;
+}
+
+#endif
+
+int getDefaultThreadCount() {
+    if (const char *value = getenv("MSDF_ATLAS_THREADS")) {
+        int threadCount = atoi(value);
+        if (threadCount > 0)
+            return threadCount;
+    }
+    return getAvailableCpuCount();
+}
+
+}
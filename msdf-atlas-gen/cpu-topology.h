@@ -0,0 +1,17 @@
+
+#pragma once
+
+namespace msdf_atlas {
+
+/// Returns the number of CPUs the process may actually use - the smaller of its CPU affinity mask and its cgroup CPU quota (rounded up)
+int getAvailableCpuCount();
+/// Returns the default number of worker threads - the value of the MSDF_ATLAS_THREADS environment variable if set, otherwise the number of available CPUs
+int getDefaultThreadCount();
+/// Pins the calling thread to one of the CPUs the process was initially allowed to run on (selected by threadNo in round robin), returns false if not supported
+bool pinCurrentThread(int threadNo);
+/// Returns the number of NUMA nodes that contain CPUs available to the process (1 if unknown)
+int getNumaNodeCount();
+/// Pins the calling thread to the available CPUs of a NUMA node (indexed among those counted by getNumaNodeCount), returns false if not supported
+bool pinCurrentThreadToNumaNode(int node);
+
+}
@@ -6,7 +6,7 @@
 
 namespace msdf_atlas {
 
-bool exportCSV(const FontGeometry *fonts, int fontCount, int atlasWidth, int atlasHeight, YDirection yDirection, const char *filename) {
+bool exportCSV(const FontGeometry *fonts, int fontCount, int atlasWidth, int atlasHeight, YDirection yDirection, const char *filename, const Rectangle *hotRegion, bool rotation) {
     FILE *f = fopen(filename, "w");
     if (!f)
         return false;
@@ -29,12 +29,17 @@ bool exportCSV(const FontGeometry *fonts, int fontCount, int atlasWidth, int atl
             glyph.getQuadAtlasBounds(l, b, r, t);
             switch (yDirection) {
                 case YDirection::BOTTOM_UP:
-                    fprintf(f, "%.17g,%.17g,%.17g,%.17g\n", l, b, r, t);
+                    fprintf(f, "%.17g,%.17g,%.17g,%.17g", l, b, r, t);
                     break;
                 case YDirection::TOP_DOWN:
-                    fprintf(f, "%.17g,%.17g,%.17g,%.17g\n", l, atlasHeight-t, r, atlasHeight-b);
+                    fprintf(f, "%.17g,%.17g,%.17g,%.17g", l, atlasHeight-t, r, atlasHeight-b);
                     break;
             }
+            if (hotRegion)
+                fprintf(f, ",%d", (int) glyph.isBoxInRegion(*hotRegion));
+            if (rotation)
+                fprintf(f, ",%d", (int) glyph.isBoxRotated());
+            fputs("\n", f);
         }
     }
 
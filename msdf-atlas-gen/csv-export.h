@@ -1,14 +1,17 @@
 
 #pragma once
 
+#include "Rectangle.h"
 #include "FontGeometry.h"
 
 namespace msdf_atlas {
 
 /**
  * Writes the positioning data and atlas layout of the glyphs into a CSV file
- * The columns are: font variant index (if fontCount > 1), glyph identifier (index or Unicode), horizontal advance, plane bounds (l, b, r, t), atlas bounds (l, b, r, t)
+ * The columns are: font variant index (if fontCount > 1), glyph identifier (index or Unicode), horizontal advance, plane bounds (l, b, r, t), atlas bounds (l, b, r, t),
+ * if hotRegion is not null, whether the glyph is in the region of the most used glyphs (1 or 0),
+ * and if rotation is true, whether the glyph is rotated 90 degrees clockwise in the atlas (1 or 0)
  */
-bool exportCSV(const FontGeometry *fonts, int fontCount, int atlasWidth, int atlasHeight, YDirection yDirection, const char *filename);
+bool exportCSV(const FontGeometry *fonts, int fontCount, int atlasWidth, int atlasHeight, YDirection yDirection, const char *filename, const Rectangle *hotRegion = nullptr, bool rotation = false);
 
 }
@@ -0,0 +1,86 @@
+
+#include "gpu-memory-model.h"
+
+#include <cstring>
+#include <algorithm>
+#include "utils.hpp"
+
+namespace msdf_atlas {
+
+static int roundUp(int x, int multiple) {
+    return multiple > 1 ? (x+multiple-1)/multiple*multiple : x;
+}
+
+static size_t roundUp(size_t x, size_t multiple) {
+    return multiple > 1 ? (x+multiple-1)/multiple*multiple : x;
+}
+
+void GpuMemoryModel::allocatedDimensions(int &width, int &height) const {
+    if (!(width > 0 && height > 0))
+        return;
+    int blockWidth = std::max(format.blockWidth, 1), blockHeight = std::max(format.blockHeight, 1);
+    int blockBytes = std::max(format.blockBytes, 1);
+    if (profile.powerOfTwo) {
+        width = ceilToPOT(width);
+        height = ceilToPOT(height);
+    }
+    width = roundUp(roundUp(width, blockWidth), std::max(profile.tileWidth, 1));
+    height = roundUp(roundUp(height, blockHeight), std::max(profile.tileHeight, 1));
+    // Whole blocks that fit into the row pitch padding are free
+    if (!profile.powerOfTwo) {
+        int rowBytes = roundUp(width/blockWidth*blockBytes, profile.rowPitchAlignment);
+        width = std::max(width, rowBytes/blockBytes*blockWidth/std::max(profile.tileWidth, 1)*std::max(profile.tileWidth, 1));
+    }
+}
+
+size_t GpuMemoryModel::allocatedBytes(int width, int height) const {
+    if (!(width > 0 && height > 0))
+        return 0;
+    allocatedDimensions(width, height);
+    int blockWidth = std::max(format.blockWidth, 1), blockHeight = std::max(format.blockHeight, 1);
+    size_t rowBytes = roundUp((size_t) (width/blockWidth)*std::max(format.blockBytes, 1), (size_t) profile.rowPitchAlignment);
+    return roundUp(rowBytes*(height/blockHeight), (size_t) profile.allocationAlignment);
+}
+
+bool getGpuMemoryProfile(GpuMemoryProfile &profile, const char *name) {
+    // Approximations of common allocation rules
+    if (!strcmp(name, "generic")) {
+        profile = GpuMemoryProfile { 1, 1, 1, 1, false };
+        return true;
+    }
+    if (!strcmp(name, "d3d12")) { // 256-byte row pitch, 64 KiB placement alignment
+        profile = GpuMemoryProfile { 256, 1, 1, 65536, false };
+        return true;
+    }
+    if (!strcmp(name, "tiled")) { // 16 x 16 pixel tiles in 4 KiB pages, typical of mobile GPUs
+        profile = GpuMemoryProfile { 64, 16, 16, 4096, false };
+        return true;
+    }
+    if (!strcmp(name, "pot")) { // Power-of-two dimensions only
+        profile = GpuMemoryProfile { 4, 1, 1, 4096, true };
+        return true;
+    }
+    return false;
+}
+
+bool getGpuTextureFormat(GpuTextureFormat &format, const char *name) {
+    if (!strcmp(name, "bc1") || !strcmp(name, "bc4") || !strcmp(name, "etc2")) {
+        format = GpuTextureFormat { 4, 4, 8 };
+        return true;
+    }
+    if (!strcmp(name, "bc5") || !strcmp(name, "bc7") || !strcmp(name, "astc4x4")) {
+        format = GpuTextureFormat { 4, 4, 16 };
+        return true;
+    }
+    if (!strcmp(name, "astc6x6")) {
+        format = GpuTextureFormat { 6, 6, 16 };
+        return true;
+    }
+    if (!strcmp(name, "astc8x8")) {
+        format = GpuTextureFormat { 8, 8, 16 };
+        return true;
+    }
+    return false;
+}
+
+}
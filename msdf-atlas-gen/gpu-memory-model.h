@@ -0,0 +1,42 @@
+
+#pragma once
+
+#include <cstddef>
+
+namespace msdf_atlas {
+
+/// Allocation rules of a GPU platform, which determine how much memory a texture of given dimensions actually occupies
+struct GpuMemoryProfile {
+    /// Alignment of each row of the texture in bytes
+    int rowPitchAlignment;
+    /// Dimensions (in pixels) of the tiles the texture is allocated in
+    int tileWidth, tileHeight;
+    /// Alignment of the size of the whole allocation in bytes
+    int allocationAlignment;
+    /// Whether both dimensions are rounded up to powers of two
+    bool powerOfTwo;
+};
+
+/// Storage format of the texture - each block of blockWidth x blockHeight pixels occupies blockBytes (blocks are 1 x 1 for uncompressed formats)
+struct GpuTextureFormat {
+    int blockWidth, blockHeight;
+    int blockBytes;
+};
+
+/// Cost model of the memory allocated for an atlas texture
+struct GpuMemoryModel {
+    GpuMemoryProfile profile;
+    GpuTextureFormat format;
+
+    /// Returns the modeled number of bytes allocated for a texture with the given dimensions
+    size_t allocatedBytes(int width, int height) const;
+    /// Enlarges the dimensions to the largest ones which still occupy the same rows and tiles of the allocation
+    void allocatedDimensions(int &width, int &height) const;
+};
+
+/// Looks up a built-in platform profile (generic, d3d12, tiled, pot), returns false if the name is not recognized
+bool getGpuMemoryProfile(GpuMemoryProfile &profile, const char *name);
+/// Looks up a block compressed texture format (bc1, bc4, bc5, bc7, etc2, astc4x4, astc6x6, astc8x8), returns false if the name is not recognized
+bool getGpuTextureFormat(GpuTextureFormat &format, const char *name);
+
+}
@@ -0,0 +1,107 @@
+
+#include "image-decode.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#ifndef MSDFGEN_DISABLE_PNG
+
+namespace msdf_atlas {
+
+template <int N>
+bool loadPng(msdfgen::Bitmap<byte, N> &output, const char *filename) {
+    FILE *f = fopen(filename, "rb");
+    if (!f)
+        return false;
+    std::vector<byte> data;
+    byte buffer[65536];
+    for (size_t length; (length = fread(buffer, 1, sizeof(buffer), f)) > 0;)
+        data.insert(data.end(), buffer, buffer+length);
+    fclose(f);
+    return !data.empty() && decodePng(output, data.data(), data.size());
+}
+
+template bool loadPng(msdfgen::Bitmap<byte, 1> &output, const char *filename);
+template bool loadPng(msdfgen::Bitmap<byte, 3> &output, const char *filename);
+template bool loadPng(msdfgen::Bitmap<byte, 4> &output, const char *filename);
+
+}
+
+#endif
+
+#ifdef MSDFGEN_USE_LIBPNG
+
+#include <png.h>
+
+namespace msdf_atlas {
+
+template <int N>
+static bool pngDecode(msdfgen::Bitmap<byte, N> &output, const byte *data, size_t length, png_uint_32 format) {
+    png_image image;
+    memset(&image, 0, sizeof(image));
+    image.version = PNG_IMAGE_VERSION;
+    if (!png_image_begin_read_from_memory(&image, data, length))
+        return false;
+    image.format = format;
+    msdfgen::Bitmap<byte, N> bitmap(image.width, image.height);
+    // Negative row stride flips the top-down rows of the PNG into the bottom-up bitmap
+    png_int_32 rowStride = N*(png_int_32) image.width;
+    if (!png_image_finish_read(&image, NULL, (byte *) bitmap, -rowStride, NULL)) {
+        png_image_free(&image);
+        return false;
+    }
+    output = (msdfgen::Bitmap<byte, N> &&) bitmap;
+    return true;
+}
+
+bool decodePng(msdfgen::Bitmap<byte, 1> &output, const byte *data, size_t length) {
+    return pngDecode(output, data, length, PNG_FORMAT_GRAY);
+}
+
+bool decodePng(msdfgen::Bitmap<byte, 3> &output, const byte *data, size_t length) {
+    return pngDecode(output, data, length, PNG_FORMAT_RGB);
+}
+
+bool decodePng(msdfgen::Bitmap<byte, 4> &output, const byte *data, size_t length) {
+    return pngDecode(output, data, length, PNG_FORMAT_RGBA);
+}
+
+}
+
+#endif
+
+#ifdef MSDFGEN_USE_LODEPNG
+
+#include <lodepng.h>
+
+namespace msdf_atlas {
+
+template <int N>
+static bool pngDecode(msdfgen::Bitmap<byte, N> &output, const byte *data, size_t length, LodePNGColorType colorType) {
+    std::vector<byte> pixels;
+    unsigned width, height;
+    if (lodepng::decode(pixels, width, height, data, length, colorType, 8))
+        return false;
+    msdfgen::Bitmap<byte, N> bitmap(width, height);
+    for (int y = 0; y < (int) height; ++y)
+        memcpy(bitmap(0, height-y-1), &pixels[N*width*y], N*width);
+    output = (msdfgen::Bitmap<byte, N> &&) bitmap;
+    return true;
+}
+
+bool decodePng(msdfgen::Bitmap<byte, 1> &output, const byte *data, size_t length) {
+    return pngDecode(output, data, length, LCT_GREY);
+}
+
+bool decodePng(msdfgen::Bitmap<byte, 3> &output, const byte *data, size_t length) {
+    return pngDecode(output, data, length, LCT_RGB);
+}
+
+bool decodePng(msdfgen::Bitmap<byte, 4> &output, const byte *data, size_t length) {
+    return pngDecode(output, data, length, LCT_RGBA);
+}
+
+}
+
+#endif
@@ -0,0 +1,25 @@
+
+#pragma once
+
+#include <cstddef>
+#include <msdfgen.h>
+#include "types.h"
+
+#ifndef MSDFGEN_DISABLE_PNG
+
+namespace msdf_atlas {
+
+// Functions to decode an image from a sequence of bytes in memory into a bottom-up bitmap
+// Only PNG format available currently
+
+bool decodePng(msdfgen::Bitmap<byte, 1> &output, const byte *data, size_t length);
+bool decodePng(msdfgen::Bitmap<byte, 3> &output, const byte *data, size_t length);
+bool decodePng(msdfgen::Bitmap<byte, 4> &output, const byte *data, size_t length);
+
+/// Loads a PNG image file into a bottom-up bitmap
+template <int N>
+bool loadPng(msdfgen::Bitmap<byte, N> &output, const char *filename);
+
+}
+
+#endif
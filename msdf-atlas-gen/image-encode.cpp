@@ -1,7 +1,7 @@
 
 #include "image-encode.h"
 
-#include <core/pixel-conversion.hpp>
+#include "simd-kernels.h"
 
 #ifdef MSDFGEN_USE_LIBPNG
 
@@ -58,8 +58,7 @@ static bool pngEncode(std::vector<byte> &output, const float *pixels, int width,
         return false;
     int subpixels = channels*width*height;
     std::vector<byte> bytePixels(subpixels);
-    for (int i = 0; i < subpixels; ++i)
-        bytePixels[i] = msdfgen::pixelFloatToByte(pixels[i]);
+    convertFloatToByte(bytePixels.data(), pixels, subpixels);
     return pngEncode(output, bytePixels.data(), width, height, channels, colorType);
 }
 
@@ -120,35 +119,22 @@ bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<msdfgen:
 
 bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 1> &bitmap) {
     std::vector<byte> pixels(bitmap.width*bitmap.height);
-    std::vector<byte>::iterator it = pixels.begin();
-    for (int y = bitmap.height-1; y >= 0; --y)
-        for (int x = 0; x < bitmap.width; ++x)
-            *it++ = msdfgen::pixelFloatToByte(*bitmap(x, y));
+    for (int y = 0; y < bitmap.height; ++y)
+        convertFloatToByte(&pixels[bitmap.width*y], bitmap(0, bitmap.height-y-1), bitmap.width);
     return !lodepng::encode(output, pixels, bitmap.width, bitmap.height, LCT_GREY);
 }
 
 bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 3> &bitmap) {
     std::vector<byte> pixels(3*bitmap.width*bitmap.height);
-    std::vector<byte>::iterator it = pixels.begin();
-    for (int y = bitmap.height-1; y >= 0; --y)
-        for (int x = 0; x < bitmap.width; ++x) {
-            *it++ = msdfgen::pixelFloatToByte(bitmap(x, y)[0]);
-            *it++ = msdfgen::pixelFloatToByte(bitmap(x, y)[1]);
-            *it++ = msdfgen::pixelFloatToByte(bitmap(x, y)[2]);
-        }
+    for (int y = 0; y < bitmap.height; ++y)
+        convertFloatToByte(&pixels[3*bitmap.width*y], bitmap(0, bitmap.height-y-1), 3*bitmap.width);
     return !lodepng::encode(output, pixels, bitmap.width, bitmap.height, LCT_RGB);
 }
 
 bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 4> &bitmap) {
     std::vector<byte> pixels(4*bitmap.width*bitmap.height);
-    std::vector<byte>::iterator it = pixels.begin();
-    for (int y = bitmap.height-1; y >= 0; --y)
-        for (int x = 0; x < bitmap.width; ++x) {
-            *it++ = msdfgen::pixelFloatToByte(bitmap(x, y)[0]);
-            *it++ = msdfgen::pixelFloatToByte(bitmap(x, y)[1]);
-            *it++ = msdfgen::pixelFloatToByte(bitmap(x, y)[2]);
-            *it++ = msdfgen::pixelFloatToByte(bitmap(x, y)[3]);
-        }
+    for (int y = 0; y < bitmap.height; ++y)
+        convertFloatToByte(&pixels[4*bitmap.width*y], bitmap(0, bitmap.height-y-1), 4*bitmap.width);
     return !lodepng::encode(output, pixels, bitmap.width, bitmap.height, LCT_RGBA);
 }
 
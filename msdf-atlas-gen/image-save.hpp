@@ -2,7 +2,9 @@
 #include "image-save.h"
 
 #include <cstdio>
+#include <vector>
 #include <msdfgen-ext.h>
+#include "simd-kernels.h"
 
 namespace msdf_atlas {
 
@@ -134,15 +136,13 @@ bool
     bool success = false;
     if (FILE *f = fopen(filename, "wb")) {
         size_t written = 0;
+        std::vector<float> row((size_t) N*bitmap.width);
         for (int y = 0; y < bitmap.height; ++y) {
             const float *p = bitmap.pixels+(size_t) N*bitmap.width*(outputYDirection == YDirection::TOP_DOWN ? bitmap.height-y-1 : y);
-            for (int x = 0; x < bitmap.width; ++x) {
-                const unsigned char *b = reinterpret_cast<const unsigned char *>(p++);
-                for (int i = sizeof(float)-1; i >= 0; --i)
-                    written += fwrite(b+i, 1, 1, f);
-            }
+            swapByteOrder32(row.data(), p, row.size());
+            written += fwrite(row.data(), sizeof(float), row.size(), f);
         }
-        success = written == sizeof(float)*N*bitmap.width*bitmap.height;
+        success = written == (size_t) N*bitmap.width*bitmap.height;
         fclose(f);
     }
     return success;
@@ -2,7 +2,10 @@
 #include "json-export.h"
 
 #include <string>
+#include <vector>
+#include <algorithm>
 #include "GlyphGeometry.h"
+#include "texture-array-export.h"
 
 namespace msdf_atlas {
 
@@ -75,6 +78,8 @@ bool exportJSON(const FontGeometry *fonts, int fontCount, ImageType imageType, c
         fprintf(f, "\"width\":%d,", metrics.width);
         fprintf(f, "\"height\":%d,", metrics.height);
         fprintf(f, "\"yOrigin\":\"%s\"", metrics.yDirection == YDirection::TOP_DOWN ? "top" : "bottom");
+        if (metrics.pageCount > 0)
+            fprintf(f, ",\"pages\":%d", metrics.pageCount);
         if (metrics.grid) {
             fputs(",\"grid\":{", f);
             fprintf(f, "\"cellWidth\":%d,", metrics.grid->cellWidth);
@@ -93,8 +98,28 @@ bool exportJSON(const FontGeometry *fonts, int fontCount, ImageType imageType, c
                         break;
                 }
             }
+            if (metrics.grid->rowLengths && metrics.grid->rowCellWidths) {
+                fputs(",\"cellWidths\":[", f);
+                for (int i = 0; i < metrics.grid->rows; ++i)
+                    fprintf(f, i ? ",%d" : "%d", metrics.grid->rowCellWidths[i]);
+                fputs("],\"rowLengths\":[", f);
+                for (int i = 0; i < metrics.grid->rows; ++i)
+                    fprintf(f, i ? ",%d" : "%d", metrics.grid->rowLengths[i]);
+                fputs("]", f);
+            }
             fputs("}", f);
         }
+        if (metrics.hotRegion) {
+            const Rectangle &region = *metrics.hotRegion;
+            switch (metrics.yDirection) {
+                case YDirection::BOTTOM_UP:
+                    fprintf(f, ",\"hotRegion\":{\"left\":%d,\"bottom\":%d,\"right\":%d,\"top\":%d}", region.x, region.y, region.x+region.w, region.y+region.h);
+                    break;
+                case YDirection::TOP_DOWN:
+                    fprintf(f, ",\"hotRegion\":{\"left\":%d,\"top\":%d,\"right\":%d,\"bottom\":%d}", region.x, metrics.height-(region.y+region.h), region.x+region.w, metrics.height-region.y);
+                    break;
+            }
+        }
     } fputs("},", f);
 
     if (fontCount > 1)
@@ -158,6 +183,14 @@ bool exportJSON(const FontGeometry *fonts, int fontCount, ImageType imageType, c
                         break;
                 }
             }
+            if (metrics.pageCount > 0)
+                fprintf(f, ",\"page\":%d", glyph.getBoxPage());
+            if (metrics.textureArrayLayers && metrics.grid && !glyph.isWhitespace())
+                fprintf(f, ",\"layer\":%d", getGridCellIndex(glyph, metrics.grid->cellWidth, metrics.grid->cellHeight, metrics.grid->columns, metrics.height));
+            if (metrics.hotRegion && glyph.isBoxInRegion(*metrics.hotRegion))
+                fputs(",\"hot\":true", f);
+            if (glyph.isBoxRotated())
+                fputs(",\"rotated\":true", f);
             fputs("}", f);
             firstGlyph = false;
         } fputs("]", f);
@@ -205,4 +238,48 @@ bool exportJSON(const FontGeometry *fonts, int fontCount, ImageType imageType, c
     return true;
 }
 
+bool exportPageIndexJSON(const JsonAtlasPage *pages, int pageCount, int width, int height, const char *filename) {
+    struct PageRange {
+        unicode_t first, last;
+        int page;
+    };
+    std::vector<PageRange> ranges;
+    for (int i = 0; i < pageCount; ++i) {
+        for (unicode_t cp : *pages[i].codepoints) {
+            if (!ranges.empty() && ranges.back().page == i && ranges.back().last+1 == cp)
+                ranges.back().last = cp;
+            else
+                ranges.push_back(PageRange { cp, cp, i });
+        }
+    }
+    std::sort(ranges.begin(), ranges.end(), [](const PageRange &a, const PageRange &b) -> bool {
+        return a.first < b.first;
+    });
+
+    FILE *f = fopen(filename, "w");
+    if (!f)
+        return false;
+    fputs("{", f);
+    fprintf(f, "\"width\":%d,", width);
+    fprintf(f, "\"height\":%d,", height);
+    fputs("\"pages\":[", f);
+    for (int i = 0; i < pageCount; ++i) {
+        fputs(i == 0 ? "{" : ",{", f);
+        if (pages[i].imageFilename)
+            fprintf(f, "\"image\":\"%s\",", escapeJsonString(pages[i].imageFilename).c_str());
+        if (pages[i].name)
+            fprintf(f, "\"name\":\"%s\",", escapeJsonString(pages[i].name).c_str());
+        fprintf(f, "\"codepoints\":%d", (int) pages[i].codepoints->size());
+        fputs("}", f);
+    } fputs("],", f);
+    // Sorted by first codepoint so that the page of a character can be looked up by binary search
+    fputs("\"ranges\":[", f);
+    for (size_t i = 0; i < ranges.size(); ++i)
+        fprintf(f, i == 0 ? "[%u,%u,%d]" : ",[%u,%u,%d]", ranges[i].first, ranges[i].last, ranges[i].page);
+    fputs("]", f);
+    fputs("}\n", f);
+    fclose(f);
+    return true;
+}
+
 }
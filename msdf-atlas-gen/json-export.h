@@ -4,6 +4,8 @@
 #include <msdfgen.h>
 #include <msdfgen-ext.h>
 #include "types.h"
+#include "Rectangle.h"
+#include "Charset.h"
 #include "FontGeometry.h"
 
 namespace msdf_atlas {
@@ -14,15 +16,33 @@ struct JsonAtlasMetrics {
         int columns, rows;
         const double *originX, *originY;
         int spacing;
+        /// Number of cells and cell width of each row (top to bottom) of a variable cell width grid, or null
+        const int *rowLengths, *rowCellWidths;
     };
     msdfgen::Range distanceRange;
     double size;
     int width, height;
     YDirection yDirection;
     const GridMetrics *grid;
+    /// Region of the atlas containing the most used glyphs (bottom-up Y), or null
+    const Rectangle *hotRegion;
+    /// Number of atlas pages, or zero if the atlas is a single image
+    int pageCount;
+    /// Whether the cells of the grid are also exported as the layers of a texture array, whose index is then listed for each glyph
+    bool textureArrayLayers;
+};
+
+/// Describes a single page of a paged atlas for the page index
+struct JsonAtlasPage {
+    const char *imageFilename;
+    const char *name;
+    const Charset *codepoints;
 };
 
 /// Writes the font and glyph metrics and atlas layout data into a comprehensive JSON file
 bool exportJSON(const FontGeometry *fonts, int fontCount, ImageType imageType, const JsonAtlasMetrics &metrics, const char *filename, bool kerning);
 
+/// Writes an index mapping ranges of Unicode codepoints to atlas pages into a JSON file
+bool exportPageIndexJSON(const JsonAtlasPage *pages, int pageCount, int width, int height, const char *filename);
+
 }
@@ -0,0 +1,225 @@
+
+#include "json-import.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+namespace msdf_atlas {
+
+/// Minimal representation of a parsed JSON value
+struct JsonValue {
+    enum Type {
+        NUL,
+        BOOLEAN,
+        NUMBER,
+        STRING,
+        ARRAY,
+        OBJECT
+    } type;
+    double number;
+    std::string string;
+    std::vector<JsonValue> elements;
+    std::vector<std::string> keys;
+
+    JsonValue() : type(NUL), number() { }
+
+    const JsonValue *operator[](const char *key) const {
+        for (size_t i = 0; i < keys.size(); ++i)
+            if (keys[i] == key)
+                return &elements[i];
+        return nullptr;
+    }
+
+};
+
+class JsonParser {
+
+public:
+    explicit JsonParser(const char *cur, const char *end) : cur(cur), end(end) { }
+
+    bool parse(JsonValue &value) {
+        skipWhitespace();
+        if (cur >= end)
+            return false;
+        switch (*cur) {
+            case '{':
+                value.type = JsonValue::OBJECT;
+                ++cur;
+                skipWhitespace();
+                if (cur < end && *cur == '}') {
+                    ++cur;
+                    return true;
+                }
+                do {
+                    value.keys.push_back(std::string());
+                    value.elements.push_back(JsonValue());
+                    skipWhitespace();
+                    if (!parseString(value.keys.back()))
+                        return false;
+                    skipWhitespace();
+                    if (!(cur < end && *cur++ == ':' && parse(value.elements.back())))
+                        return false;
+                    skipWhitespace();
+                } while (cur < end && *cur == ',' && ++cur);
+                return cur < end && *cur++ == '}';
+            case '[':
+                value.type = JsonValue::ARRAY;
+                ++cur;
+                skipWhitespace();
+                if (cur < end && *cur == ']') {
+                    ++cur;
+                    return true;
+                }
+                do {
+                    value.elements.push_back(JsonValue());
+                    if (!parse(value.elements.back()))
+                        return false;
+                    skipWhitespace();
+                } while (cur < end && *cur == ',' && ++cur);
+                return cur < end && *cur++ == ']';
+            case '"':
+                value.type = JsonValue::STRING;
+                return parseString(value.string);
+            case 't':
+                value.type = JsonValue::BOOLEAN;
+                value.number = 1;
+                return parseLiteral("true");
+            case 'f':
+                value.type = JsonValue::BOOLEAN;
+                return parseLiteral("false");
+            case 'n':
+                return parseLiteral("null");
+            default: {
+                std::string number(cur, std::min<size_t>(end-cur, 64));
+                char *numberEnd = nullptr;
+                value.type = JsonValue::NUMBER;
+                value.number = strtod(number.c_str(), &numberEnd);
+                if (numberEnd == number.c_str())
+                    return false;
+                cur += numberEnd-number.c_str();
+                return true;
+            }
+        }
+    }
+
+private:
+    const char *cur, *end;
+
+    void skipWhitespace() {
+        while (cur < end && (*cur == ' ' || *cur == '\t' || *cur == '\n' || *cur == '\r'))
+            ++cur;
+    }
+
+    bool parseLiteral(const char *literal) {
+        size_t length = strlen(literal);
+        if ((size_t) (end-cur) < length || memcmp(cur, literal, length))
+            return false;
+        cur += length;
+        return true;
+    }
+
+    bool parseString(std::string &str) {
+        if (!(cur < end && *cur++ == '"'))
+            return false;
+        while (cur < end && *cur != '"') {
+            if (*cur == '\\') {
+                if (++cur >= end)
+                    return false;
+                switch (*cur) {
+                    case 'n': str.push_back('\n'); break;
+                    case 'r': str.push_back('\r'); break;
+                    case 't': str.push_back('\t'); break;
+                    case 'b': str.push_back('\b'); break;
+                    case 'f': str.push_back('\f'); break;
+                    case 'u':
+                        // Names are not needed for the layout, keep the escape sequence as is
+                        str.push_back('\\');
+                        // fallthrough
+                    default:
+                        str.push_back(*cur);
+                }
+                ++cur;
+            } else
+                str.push_back(*cur++);
+        }
+        return cur < end && *cur++ == '"';
+    }
+
+};
+
+static bool readBounds(const JsonValue *bounds, double &l, double &b, double &r, double &t, bool topDown, int height) {
+    if (!(bounds && bounds->type == JsonValue::OBJECT))
+        return false;
+    const JsonValue *left = (*bounds)["left"], *bottom = (*bounds)["bottom"], *right = (*bounds)["right"], *top = (*bounds)["top"];
+    if (!(left && bottom && right && top))
+        return false;
+    l = left->number, r = right->number;
+    if (topDown)
+        b = height-bottom->number, t = height-top->number;
+    else
+        b = bottom->number, t = top->number;
+    return true;
+}
+
+int importJSON(GlyphGeometry *glyphs, const FontGeometry *fonts, int fontCount, const char *filename, int &width, int &height) {
+    FILE *f = fopen(filename, "rb");
+    if (!f)
+        return -1;
+    std::vector<char> data;
+    char buffer[65536];
+    for (size_t length; (length = fread(buffer, 1, sizeof(buffer), f)) > 0;)
+        data.insert(data.end(), buffer, buffer+length);
+    fclose(f);
+
+    JsonValue root;
+    if (!JsonParser(data.data(), data.data()+data.size()).parse(root) || root.type != JsonValue::OBJECT)
+        return -1;
+    const JsonValue *atlas = root["atlas"];
+    if (!(atlas && (*atlas)["width"] && (*atlas)["height"]))
+        return -1;
+    width = (int) (*atlas)["width"]->number;
+    height = (int) (*atlas)["height"]->number;
+    const JsonValue *yOrigin = (*atlas)["yOrigin"];
+    bool topDown = yOrigin && yOrigin->string == "top";
+
+    std::vector<const JsonValue *> variants;
+    if (const JsonValue *variantArray = root["variants"]) {
+        for (const JsonValue &variant : variantArray->elements)
+            variants.push_back(&variant);
+    } else
+        variants.push_back(&root);
+    if ((int) variants.size() != fontCount)
+        return -1;
+
+    int unplaced = 0;
+    for (int i = 0; i < fontCount; ++i) {
+        const FontGeometry &font = fonts[i];
+        std::vector<bool> placed(font.getGlyphs().size());
+        const GlyphGeometry *firstGlyph = font.getGlyphs().begin();
+        if (const JsonValue *glyphArray = (*variants[i])["glyphs"]) {
+            for (const JsonValue &glyphValue : glyphArray->elements) {
+                const GlyphGeometry *glyph = nullptr;
+                if (const JsonValue *unicode = glyphValue["unicode"])
+                    glyph = font.getGlyph((unicode_t) unicode->number);
+                else if (const JsonValue *index = glyphValue["index"])
+                    glyph = font.getGlyph(msdfgen::GlyphIndex((unsigned) index->number));
+                if (!glyph)
+                    continue;
+                double l = 0, b = 0, r = 0, t = 0;
+                readBounds(glyphValue["atlasBounds"], l, b, r, t, topDown, height);
+                const JsonValue *rotated = glyphValue["rotated"];
+                if (glyphs[glyph-glyphs].placeBoxAtQuadAtlasBounds(l, b, r, t, rotated && rotated->number))
+                    placed[glyph-firstGlyph] = true;
+            }
+        }
+        for (bool glyphPlaced : placed)
+            unplaced += !glyphPlaced;
+    }
+    return unplaced;
+}
+
+}
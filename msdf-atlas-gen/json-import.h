@@ -0,0 +1,17 @@
+
+#pragma once
+
+#include "types.h"
+#include "GlyphGeometry.h"
+#include "FontGeometry.h"
+
+namespace msdf_atlas {
+
+/**
+ * Places glyphs as described by the JSON layout of a prebuilt atlas (see exportJSON) and outputs the atlas dimensions.
+ * The glyphs of the fonts must be stored in the glyphs array and already wrapped with the attributes the atlas was built with.
+ * Returns the number of glyphs that could not be placed (0 on success) or -1 if the file could not be read.
+ */
+int importJSON(GlyphGeometry *glyphs, const FontGeometry *fonts, int fontCount, const char *filename, int &width, int &height);
+
+}
@@ -22,6 +22,7 @@
 #include <vector>
 #include <algorithm>
 #include <thread>
+#include <csignal>
 
 #include "msdf-atlas-gen.h"
 
@@ -31,6 +32,7 @@ using namespace msdf_atlas;
 #define DEFAULT_ANGLE_THRESHOLD 3.0
 #define DEFAULT_MITER_LIMIT 1.0
 #define DEFAULT_PIXEL_RANGE 2.0
+#define DEFAULT_HOT_COVERAGE .9
 #define SDF_ERROR_ESTIMATE_PRECISION 19
 #define GLYPH_FILL_RULE msdfgen::FILL_NONZERO
 #define LCG_MULTIPLIER 6364136223846793005ull
@@ -105,7 +107,11 @@ MSDF 图集生成器 by Viktor Chlumsky 版本 )" MSDF_ATLAS_VERSION_STRING R"(
 #ifndef MSDFGEN_DISABLE_VARIABLE_FONTS
 R"(
   -varfont <文件名.ttf/otf?var0=value0&var1=value1>
-      指定一个可变字体文件并配置其变量。)"
+      指定一个可变字体文件并配置其变量。
+  -varinstances <实例1,实例2,...>
+      与 -varfont 一起使用，在同一个图集中生成可变字体的多个实例，每个实例成为一个变体。
+      每个实例可以是标准字重名称（Thin, ExtraLight, Light, Regular, Medium, SemiBold, Bold, ExtraBold, Black）
+      或轴坐标（例如 wght=300&wdth=75）。字体文件只读取一次，各实例的字形并行加载。)"
 #endif
 R"(
   -charset <文件名>
@@ -118,6 +124,12 @@ R"(
       内联指定字形索引集。请参考文档了解其语法。
   -allglyphs
       指定处理字体文件中的所有字形。
+  -charsetfromtext <文件名1.txt> <文件名2.txt> ...
+      扫描 UTF-8 文本语料库（并行处理），将其中出现的所有字符作为输入字符集。
+    -charsettop <N>
+        仅保留语料库中出现频率最高的 N 个字符。
+    -charsetcoverage <百分比>
+        仅保留按频率排序后合计覆盖指定百分比文本的字符（例如 99.9）。
   -fontscale <缩放比例>
       指定应用于字体字形几何的缩放比例。
   -fontname <名称>
@@ -144,6 +156,28 @@ R"(
   -pots / -potr / -square / -square2 / -square4
       选择能够容纳所有字形并满足选定约束的最小图集尺寸：
       二次幂正方形 / 二次幂矩形 / 任意正方形 / 边长可被2整除的正方形 / 边长可被4整除的正方形
+  -rect
+      选择面积最小的任意宽高比图集尺寸（并行尝试多种宽高比，再分别收缩宽度和高度）。
+  -maxdimensions <宽度> <高度>
+      使用 -rect 或 -gpuprofile 时限制图集的最大尺寸（0 表示不限制）。
+  -gpuprofile <generic / d3d12 / tiled / pot>
+      选择使建模显存占用最小的图集尺寸，按所选平台的分配规则（行跨距对齐、分块尺寸、分配对齐、二次幂尺寸）建模，
+      并将图集扩展到所占分配的完整尺寸。会报告所选尺寸的建模显存占用。
+  -gpuformat <bc1 / bc4 / bc5 / bc7 / etc2 / astc4x4 / astc6x6 / astc8x8>
+      按块压缩纹理格式计算显存模型（需要 -gpuprofile 或 -gpualignment）。不指定时使用与图集像素格式对应的未压缩格式。
+  -gpualignment <行跨距字节数> <分块宽度> <分块高度> <分配对齐字节数>
+      覆盖 -gpuprofile 所选平台的对齐规则。
+  -packportfolio
+      对每个候选尺寸并行尝试多种矩形排序（按高度、面积、周长等）与放置规则的组合，保留能得到最小图集尺寸的结果。结果是确定性的。
+  -fastpack
+      使用按高度排序的货架（shelf）打包算法，速度远快于默认算法但图集不够紧凑，适用于数万个以上字形。
+      不指定时，至少 16384 个字形的尺寸和缩放搜索也会使用货架算法，最终布局再由默认算法优化。
+  -partitions <N>
+      分层打包：按高度将字形分为 N 个分区，各分区并行打包到各自的区域中，再将这些区域打包到图集中。
+      会报告相对字形总面积的额外面积开销。
+  -allowrotation
+      允许将字形顺时针旋转 90 度放入图集以提高紧凑度。旋转的字形在 JSON 中标记为 "rotated":true，
+      在 CSV 中增加一列旋转标志（1 或 0），在 Artery Font 中列于 JSON 元数据的 rotatedGlyphs 中。网格布局不受影响。
   -uniformgrid
       将图集布局为均匀网格。启用以下以 -uniform 开头的选项：
     -uniformcols <N>
@@ -154,8 +188,23 @@ R"(
         将单元格尺寸约束到给定规则（参见上面的 -pots / ...）。
     -uniformorigin <off / on / horizontal / vertical>
         设置每个单元格中字形原点是否应固定在相同位置。
+    -variablegrid
+        行高固定，但每行的单元格宽度只取该行最宽字形的宽度，适用于比例字体。单元格仍可按行号和行内序号寻址，
+        JSON 中导出每行的单元格宽度（cellWidths）和单元格数（rowLengths）。
+        若指定了 -uniformcols，每行最多包含该数量的单元格。要求原点在水平方向不固定。
   -yorigin <bottom / top>
       确定 Y 轴是向上（底部原点，默认）还是向下（顶部原点）。
+  -glyphweights <文件名>
+      从文件中加载字形的使用权重（每行一个 "<码位或字形索引> <权重>"），并将最常用的字形集中打包到图集的一个紧凑区域（热区）中。
+      如果未指定该文件，则使用 -charsetfromtext 语料库中的字符频率。
+  -hotcoverage <百分比>
+      热区中的字形合计应覆盖的使用权重百分比。默认值为 90。
+  -pagegroups <blocks / 文件名>
+      将字形按 Unicode 区块（blocks）或文件中的分组（每行一个字符集）分配到多个图集页面，每个页面保存为单独的图像。
+      图像文件名由 -imageout 派生（例如 atlas.png -> atlas_0.png, atlas_1.png, ...）。如果指定了字形权重，最常用的字形将组成第一个页面。
+      所有页面共享相同的尺寸和字形尺寸。未指定 -size 时，字形尺寸为最受限的页面在该尺寸内能容纳的最大值。
+  -pagemaxglyphs <N>
+      每个页面最多包含的字形数量，较大的分组将被拆分为多个页面。
 
 输出规范 - 可以指定一个或多个
   -imageout <文件名.*>
@@ -163,7 +212,13 @@ R"(
   -json <文件名.json>
       将图集的布局数据以及其他指标写入结构化的 JSON 文件。
   -csv <文件名.csv>
-      将字形的布局数据写入简单的 CSV 文件。)"
+      将字形的布局数据写入简单的 CSV 文件。
+  -pageindex <文件名.json>
+      写入分页图集的索引，将 Unicode 码位范围映射到页面，以便运行时按需加载页面。
+  -texarray <文件名.ktx2>
+      将均匀网格图集的每个单元格保存为 KTX2 二维纹理数组的一层（每层一个字形），JSON 中为每个字形列出层索引（layer）。
+  -texarraycompression <none / bc4>
+      设置纹理数组的块压缩格式。bc4 仅适用于单通道图集（hardmask, softmask, sdf, psdf）。默认不压缩。)"
 #ifndef MSDF_ATLAS_NO_ARTERY_FONT
 R"(
   -arfont <文件名.arfont>
@@ -178,6 +233,8 @@ R"(
       指定图集位图中字形的尺寸（像素每 em）。
   -minsize <em尺寸>
        指定最小尺寸。将使用适合相同图集尺寸的最大可能尺寸。
+  -scalehint <em尺寸>
+       指定预期的字形尺寸（例如上次运行的结果），尺寸搜索将从该值开始，而不是从估算的范围开始。会报告打包尝试次数。
   -emrange <em范围宽度>
       指定可表示的 SDF 距离范围的宽度（以 em 为单位）。
   -pxrange <像素范围宽度>
@@ -233,7 +290,15 @@ R"(
   -seed <N>
       设置边着色启发器的初始种子。
   -threads <N>
-      设置并行计算的线程数。(0 表示自动)
+      设置并行计算的线程数。(0 表示自动：使用环境变量 MSDF_ATLAS_THREADS，否则使用进程可用的 CPU 数，考虑 CPU 亲和性和 cgroup 配额)
+  -pinthreads
+      将每个工作线程绑定到不同的可用 CPU 上。
+  -simd <scalar / sse4.1 / avx2 / avx512 / neon>
+      强制使用指定指令集级别的优化内核（默认自动检测），用于测试和性能比较。
+  -numa
+      按 NUMA 节点对工作线程分组，每组并行初始化并生成图集中属于自己的行带，使内存页位于写入它们的节点上。
+  -progress
+      在生成图集时显示进度和预计剩余时间。
 )";
 
 static const char *errorCorrectionHelpText = R"(
@@ -303,31 +368,389 @@ static bool strStartsWith(const char *str, const char *prefix) {
     return true;
 }
 
+/// Loads lines of "<identifier> <weight>" where the identifier is a Unicode codepoint or glyph index (decimal or hexadecimal with 0x prefix)
+static bool loadGlyphWeights(std::map<int, double> &weights, const char *filename) {
+    FILE *f = fopen(filename, "r");
+    if (!f)
+        return false;
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        int identifier;
+        double weight;
+        if (sscanf(line, "%i %lf", &identifier, &weight) == 2 && weight >= 0)
+            weights[identifier] = weight;
+    }
+    fclose(f);
+    return true;
+}
+
+/// Loads page groups, one charset specification per line
+static bool loadPageGroups(std::vector<Charset> &groups, const char *filename) {
+    FILE *f = fopen(filename, "rb");
+    if (!f)
+        return false;
+    std::string line;
+    bool success = true;
+    for (int c = 0; c >= 0 && success;) {
+        c = fgetc(f);
+        if (c >= 0 && c != '\n') {
+            line.push_back((char) c);
+            continue;
+        }
+        if (line.find_first_not_of(" \t\r") != std::string::npos) {
+            Charset group;
+            if ((success = group.parse(line.c_str(), line.size())))
+                groups.push_back((Charset &&) group);
+        }
+        line.clear();
+    }
+    fclose(f);
+    return success;
+}
+
+/// Assigns each glyph to an atlas page by its Unicode block or group, most used glyphs first, returns the number of pages or -1 if a glyph has no codepoint
+static int assignGlyphPages(std::vector<GlyphGeometry> &glyphs, std::vector<std::string> &pageNames, const std::vector<Charset> &groups, const std::vector<double> &glyphWeights, double hotCoverage, unsigned maxPageGlyphs) {
+    struct GlyphGroup {
+        long long key;
+        std::string name;
+    };
+    std::vector<GlyphGroup> glyphGroups(glyphs.size());
+    for (size_t i = 0; i < glyphs.size(); ++i) {
+        unicode_t codepoint = glyphs[i].getCodepoint();
+        if (!codepoint)
+            return -1;
+        GlyphGroup &group = glyphGroups[i];
+        if (groups.empty()) {
+            if (const UnicodeBlock *block = findUnicodeBlock(codepoint)) {
+                group.key = block->first;
+                group.name = block->name;
+            } else {
+                group.key = 0x110000;
+                group.name = "Unassigned";
+            }
+        } else {
+            group.key = (long long) groups.size();
+            group.name = "Other";
+            for (size_t j = 0; j < groups.size(); ++j) {
+                if (groups[j].contains(codepoint)) {
+                    char name[32];
+                    sprintf(name, "Group %d", (int) j+1);
+                    group.key = (long long) j;
+                    group.name = name;
+                    break;
+                }
+            }
+        }
+    }
+
+    // Codepoints whose glyphs together cover the hot share of the total weight form the first page
+    // 字形合计覆盖热区权重份额的码位组成第一个页面
+    if (!glyphWeights.empty()) {
+        std::map<unicode_t, double> codepointWeights;
+        double totalWeight = 0, hotWeight = 0;
+        for (size_t i = 0; i < glyphs.size(); ++i) {
+            double &weight = codepointWeights[glyphs[i].getCodepoint()];
+            weight = std::max(weight, glyphWeights[i]);
+        }
+        std::vector<std::pair<double, unicode_t> > order;
+        for (const std::pair<const unicode_t, double> &codepointWeight : codepointWeights) {
+            order.push_back(std::make_pair(codepointWeight.second, codepointWeight.first));
+            totalWeight += codepointWeight.second;
+        }
+        std::stable_sort(order.begin(), order.end(), [](const std::pair<double, unicode_t> &a, const std::pair<double, unicode_t> &b) -> bool {
+            return a.first > b.first;
+        });
+        std::vector<unicode_t> hotCodepointList;
+        for (size_t i = 0; i < order.size() && hotWeight < hotCoverage*totalWeight && order[i].first > 0; ++i) {
+            hotCodepointList.push_back(order[i].second);
+            hotWeight += order[i].first;
+        }
+        Charset hotCodepoints;
+        hotCodepoints.add(hotCodepointList.data(), hotCodepointList.size());
+        for (size_t i = 0; i < glyphs.size(); ++i) {
+            if (hotCodepoints.contains(glyphs[i].getCodepoint())) {
+                glyphGroups[i].key = -1;
+                glyphGroups[i].name = "Hot";
+            }
+        }
+    }
+
+    std::vector<int> order(glyphs.size());
+    for (size_t i = 0; i < order.size(); ++i)
+        order[i] = (int) i;
+    std::sort(order.begin(), order.end(), [&glyphs, &glyphGroups](int a, int b) -> bool {
+        if (glyphGroups[a].key != glyphGroups[b].key)
+            return glyphGroups[a].key < glyphGroups[b].key;
+        if (glyphs[a].getCodepoint() != glyphs[b].getCodepoint())
+            return glyphs[a].getCodepoint() < glyphs[b].getCodepoint();
+        return a < b;
+    });
+    // Large groups are split between distinct codepoints so that each codepoint maps to a single page
+    // 较大的分组在不同码位之间拆分，使每个码位只对应一个页面
+    int page = -1, groupPart = 0;
+    unsigned pageGlyphCount = 0;
+    for (size_t i = 0; i < order.size(); ++i) {
+        const GlyphGroup &group = glyphGroups[order[i]];
+        bool newGroup = i == 0 || group.key != glyphGroups[order[i-1]].key;
+        bool split = !newGroup && maxPageGlyphs > 0 && pageGlyphCount >= maxPageGlyphs && glyphs[order[i]].getCodepoint() != glyphs[order[i-1]].getCodepoint();
+        if (newGroup || split) {
+            ++page;
+            pageGlyphCount = 0;
+            groupPart = newGroup ? 1 : groupPart+1;
+            if (groupPart > 1) {
+                char suffix[16];
+                sprintf(suffix, " (%d)", groupPart);
+                pageNames.push_back(group.name+suffix);
+            } else
+                pageNames.push_back(group.name);
+        }
+        glyphs[order[i]].setBoxPage(page);
+        ++pageGlyphCount;
+    }
+    return page+1;
+}
+
+/// Packs each page of glyphs with a copy of the configured packer, returns the number of glyphs that did not fit or -1 on failure
+static int packAtlasPages(std::vector<GlyphGeometry> &glyphs, int pageCount, const TightAtlasPacker &packer, int threadCount, int &width, int &height) {
+    std::vector<std::vector<GlyphGeometry> > pageGlyphs(pageCount);
+    std::vector<std::vector<size_t> > pageGlyphIndices(pageCount);
+    for (size_t i = 0; i < glyphs.size(); ++i) {
+        pageGlyphs[glyphs[i].getBoxPage()].push_back(glyphs[i]);
+        pageGlyphIndices[glyphs[i].getBoxPage()].push_back(i);
+    }
+    std::vector<int> remaining(pageCount);
+    std::vector<int> pageWidths(pageCount), pageHeights(pageCount);
+    Workload(pageCount).finish([&](int page, int) -> bool {
+        TightAtlasPacker pagePacker(packer);
+        pagePacker.setThreadCount(std::max(threadCount/pageCount, 1));
+        remaining[page] = pagePacker.pack(pageGlyphs[page].data(), pageGlyphs[page].size());
+        pagePacker.getDimensions(pageWidths[page], pageHeights[page]);
+        return true;
+    }, threadCount);
+
+    // All pages share the dimensions of the largest one, boxes stay valid as their Y coordinates are bottom-up
+    // 所有页面共享最大页面的尺寸，由于字形框的 Y 坐标自下而上，其位置保持有效
+    int totalRemaining = 0;
+    width = 0, height = 0;
+    for (int i = 0; i < pageCount; ++i) {
+        if (remaining[i] < 0)
+            return -1;
+        totalRemaining += remaining[i];
+        width = std::max(width, pageWidths[i]);
+        height = std::max(height, pageHeights[i]);
+        for (size_t j = 0; j < pageGlyphs[i].size(); ++j)
+            glyphs[pageGlyphIndices[i][j]] = (GlyphGeometry &&) pageGlyphs[i][j];
+    }
+    return totalRemaining;
+}
+
+/// Returns the largest glyph scale at which every page fits the dimensions of the packer, which is that of the most constrained page, or 0 on failure
+static double maximizePageScale(const std::vector<GlyphGeometry> &glyphs, int pageCount, const TightAtlasPacker &packer, int threadCount) {
+    std::vector<std::vector<GlyphGeometry> > pageGlyphs(pageCount);
+    for (const GlyphGeometry &glyph : glyphs)
+        pageGlyphs[glyph.getBoxPage()].push_back(glyph);
+    std::vector<double> pageScales(pageCount);
+    Workload(pageCount).finish([&](int page, int) -> bool {
+        // A page of only whitespace fits at any scale and does not constrain it
+        bool empty = true;
+        for (const GlyphGeometry &glyph : pageGlyphs[page])
+            empty &= glyph.isWhitespace();
+        if (empty) {
+            pageScales[page] = -1;
+            return true;
+        }
+        TightAtlasPacker pagePacker(packer);
+        pagePacker.setThreadCount(std::max(threadCount/pageCount, 1));
+        pageScales[page] = pagePacker.pack(pageGlyphs[page].data(), (int) pageGlyphs[page].size()) ? 0 : pagePacker.getScale();
+        return true;
+    }, threadCount);
+    double scale = -1;
+    for (double pageScale : pageScales)
+        if (pageScale >= 0 && (scale < 0 || pageScale < scale))
+            scale = pageScale;
+    return std::max(scale, 0.);
+}
+
+static std::string pageFilename(const char *filename, int page) {
+    std::string name(filename);
+    size_t extension = name.find_last_of("./\\");
+    if (extension == std::string::npos || name[extension] != '.')
+        extension = name.size();
+    char suffix[16];
+    sprintf(suffix, "_%d", page);
+    return name.insert(extension, suffix);
+}
+
 #ifndef MSDFGEN_DISABLE_VARIABLE_FONTS
+static void setVarFontCoordinates(msdfgen::FreetypeHandle *library, msdfgen::FontHandle *font, const char *coordinates) {
+    std::string buffer;
+    do {
+        buffer.clear();
+        while (*coordinates && *coordinates != '=')
+            buffer.push_back(*coordinates++);
+        if (*coordinates == '=') {
+            double value = 0;
+            int skip = 0;
+            if (sscanf(++coordinates, "%lf%n", &value, &skip) == 1) {
+                msdfgen::setFontVariationAxis(library, font, buffer.c_str(), value);
+                coordinates += skip;
+            }
+        }
+    } while (*coordinates++ == '&');
+}
+
 static msdfgen::FontHandle *loadVarFont(msdfgen::FreetypeHandle *library, const char *filename) {
     std::string buffer;
     while (*filename && *filename != '?')
         buffer.push_back(*filename++);
     msdfgen::FontHandle *font = msdfgen::loadFont(library, buffer.c_str());
-    if (font && *filename++ == '?') {
-        do {
-            buffer.clear();
-            while (*filename && *filename != '=')
-                buffer.push_back(*filename++);
-            if (*filename == '=') {
-                double value = 0;
-                int skip = 0;
-                if (sscanf(++filename, "%lf%n", &value, &skip) == 1) {
-                    msdfgen::setFontVariationAxis(library, font, buffer.c_str(), value);
-                    filename += skip;
-                }
-            }
-        } while (*filename++ == '&');
-    }
+    if (font && *filename++ == '?')
+        setVarFontCoordinates(library, font, filename);
     return font;
 }
+
+/// Translates a standard weight name (Thin ... Black) to the corresponding value of the wght axis
+static bool parseWeightName(double &weight, const char *name) {
+    static const struct {
+        const char *name;
+        double weight;
+    } weightNames[] = {
+        { "THIN", 100 }, { "HAIRLINE", 100 },
+        { "EXTRALIGHT", 200 }, { "ULTRALIGHT", 200 },
+        { "LIGHT", 300 },
+        { "REGULAR", 400 }, { "NORMAL", 400 },
+        { "MEDIUM", 500 },
+        { "SEMIBOLD", 600 }, { "DEMIBOLD", 600 },
+        { "BOLD", 700 },
+        { "EXTRABOLD", 800 }, { "ULTRABOLD", 800 },
+        { "BLACK", 900 }, { "HEAVY", 900 }
+    };
+    for (const auto &weightName : weightNames) {
+        const char *a = name, *b = weightName.name;
+        while (*a && *b && toupper(*a) == *b)
+            ++a, ++b;
+        if (!*a && !*b) {
+            weight = weightName.weight;
+            return true;
+        }
+    }
+    return false;
+}
+
+/// Holds the font faces of the instances of a variable font, all sharing a single in-memory copy of the font file
+class VarFontInstances {
+
+public:
+    VarFontInstances() { }
+    ~VarFontInstances() {
+        for (msdfgen::FontHandle *font : fonts)
+            if (font)
+                msdfgen::destroyFont(font);
+        for (msdfgen::FreetypeHandle *ft : handles)
+            if (ft)
+                msdfgen::deinitializeFreetype(ft);
+    }
+    /// Loads the file of a -varfont specification with its base coordinates and the coordinates of each instance (a weight name or axis coordinates)
+    bool load(const char *varFontSpec, const std::vector<std::string> &instanceSpecs, int threadCount) {
+        std::string filename;
+        while (*varFontSpec && *varFontSpec != '?')
+            filename.push_back(*varFontSpec++);
+        if (*varFontSpec == '?')
+            baseCoordinates = varFontSpec+1;
+        if (FILE *f = fopen(filename.c_str(), "rb")) {
+            fseek(f, 0, SEEK_END);
+            long length = ftell(f);
+            fseek(f, 0, SEEK_SET);
+            if (length > 0) {
+                data.resize(length);
+                if (fread(data.data(), 1, length, f) != (size_t) length)
+                    data.clear();
+            }
+            fclose(f);
+        }
+        if (data.empty())
+            return false;
+        double weight;
+        for (const std::string &instanceSpec : instanceSpecs)
+            if (!(parseWeightName(weight, instanceSpec.c_str()) || strchr(instanceSpec.c_str(), '=')))
+                return false;
+        this->instanceSpecs = instanceSpecs;
+        handles.resize(threadCount);
+        fonts.resize((size_t) threadCount*instanceSpecs.size());
+        for (size_t i = 0; i < instanceSpecs.size(); ++i)
+            if (!face(0, i))
+                return false;
+        return true;
+    }
+    size_t size() const {
+        return instanceSpecs.size();
+    }
+    /// Returns the face of an instance for the exclusive use of the given thread, which is loaded on first use
+    msdfgen::FontHandle *face(int threadNo, size_t instance) {
+        msdfgen::FontHandle *&font = fonts[threadNo*instanceSpecs.size()+instance];
+        if (!font) {
+            // Each thread has its own FreeType library handle so that faces may be used concurrently
+            msdfgen::FreetypeHandle *&ft = handles[threadNo];
+            if (!ft && !(ft = msdfgen::initializeFreetype()))
+                return nullptr;
+            if (!(font = msdfgen::loadFontData(ft, data.data(), (int) data.size())))
+                return nullptr;
+            if (!baseCoordinates.empty())
+                setVarFontCoordinates(ft, font, baseCoordinates.c_str());
+            double weight;
+            if (parseWeightName(weight, instanceSpecs[instance].c_str()))
+                msdfgen::setFontVariationAxis(ft, font, "wght", weight);
+            else
+                setVarFontCoordinates(ft, font, instanceSpecs[instance].c_str());
+        }
+        return font;
+    }
+
+private:
+    std::vector<msdfgen::byte> data;
+    std::string baseCoordinates;
+    std::vector<std::string> instanceSpecs;
+    std::vector<msdfgen::FreetypeHandle *> handles;
+    std::vector<msdfgen::FontHandle *> fonts;
+
+    VarFontInstances(const VarFontInstances &);
+    VarFontInstances &operator=(const VarFontInstances &);
+
+};
 #endif
 
+/// Lists the glyphs of the charset, or of all glyph indices below allGlyphCount, that are missing from fontGeometry
+static void reportMissingGlyphs(const FontGeometry &fontGeometry, int glyphsLoaded, const Charset &charset, unsigned allGlyphCount, GlyphIdentifierType glyphIdentifierType, const char *instanceName) {
+    if (glyphsLoaded < (int) charset.size()) {
+        fprintf(stderr, "缺失 %d 个%s", (int) charset.size()-glyphsLoaded, glyphIdentifierType == GlyphIdentifierType::UNICODE_CODEPOINT ? "码位" : "字形");
+        if (instanceName)
+            fprintf(stderr, "（实例 \"%s\"）", instanceName);
+        bool first = true;
+        switch (glyphIdentifierType) {
+            case GlyphIdentifierType::GLYPH_INDEX:
+                for (unicode_t cp : charset)
+                    if (!fontGeometry.getGlyph(msdfgen::GlyphIndex(cp)))
+                        fprintf(stderr, "%c 0x%02X", first ? ((first = false), ':') : ',', cp);
+                break;
+            case GlyphIdentifierType::UNICODE_CODEPOINT:
+                for (unicode_t cp : charset)
+                    if (!fontGeometry.getGlyph(cp))
+                        fprintf(stderr, "%c 0x%02X", first ? ((first = false), ':') : ',', cp);
+                break;
+        }
+        fprintf(stderr, "\n");
+    } else if (glyphsLoaded < (int) allGlyphCount) {
+        fprintf(stderr, "缺失 %d 个字形", (int) allGlyphCount-glyphsLoaded);
+        if (instanceName)
+            fprintf(stderr, "（实例 \"%s\"）", instanceName);
+        bool first = true;
+        for (unsigned i = 0; i < allGlyphCount; ++i)
+            if (!fontGeometry.getGlyph(msdfgen::GlyphIndex(i)))
+                fprintf(stderr, "%c 0x%02X", first ? ((first = false), ':') : ',', i);
+        fprintf(stderr, "\n");
+    }
+}
+
 enum class Units {
     /// Value is specified in ems
     /// 值以 em 为单位指定
@@ -340,9 +763,14 @@ enum class Units {
 struct FontInput {
     const char *fontFilename;
     bool variableFont;
+    const char *varInstances;
     GlyphIdentifierType glyphIdentifierType;
     const char *charsetFilename;
     const char *charsetString;
+    const char *const *corpusFilenames;
+    int corpusFileCount;
+    unsigned corpusTop;
+    double corpusCoverage;
     double fontScale;
     const char *fontName;
 };
@@ -361,6 +789,7 @@ struct Configuration {
         int cellWidth, cellHeight;
         int cols, rows;
         bool fixedOriginX, fixedOriginY;
+        bool variableWidths;
     } grid;
     void (*edgeColoring)(msdfgen::Shape &, double, unsigned long long);
     bool expensiveColoring;
@@ -373,16 +802,97 @@ struct Configuration {
     const char *imageFilename;
     const char *jsonFilename;
     const char *csvFilename;
+    const char *textureArrayFilename;
+    TextureArrayCompression textureArrayCompression;
     const char *shadronPreviewFilename;
     const char *shadronPreviewText;
+    int pageCount;
+    const std::string *pageImageFilenames;
+    const CancellationToken *cancellationToken;
+    bool progress;
+    bool pinThreads;
+    bool numaAffinity;
 };
 
+// Raised by Ctrl+C so that the build stops at the next chunk instead of leaving incomplete output files
+// 由 Ctrl+C 触发，使生成过程在下一个块处停止，而不是留下不完整的输出文件
+static CancellationToken interruptToken;
+
+static void interruptHandler(int) {
+    interruptToken.cancel();
+    // A second Ctrl+C terminates immediately // 再次按下 Ctrl+C 将立即终止
+    signal(SIGINT, SIG_DFL);
+}
+
+static void printProgress(int completed, int total, double remainingSeconds) {
+    fprintf(stderr, "\r生成进度：%d / %d（预计剩余 %.0f 秒）", completed, total, remainingSeconds);
+    if (completed == total)
+        fputc('\n', stderr);
+}
+
+template <typename T, typename S, int N, GeneratorFunction<S, N> GEN_FN>
+static bool makeAtlasPages(const std::vector<GlyphGeometry> &glyphs, const Configuration &config) {
+    std::vector<std::vector<GlyphGeometry> > pageGlyphs(config.pageCount);
+    for (const GlyphGeometry &glyph : glyphs)
+        pageGlyphs[glyph.getBoxPage()].push_back(glyph);
+    // Pages are generated in parallel, remaining threads are given to the glyphs of each page
+    // 页面并行生成，剩余线程分配给每个页面内的字形
+    int pageThreadCount = std::min(config.threadCount, config.pageCount);
+    int glyphThreadCount = std::max(config.threadCount/pageThreadCount, 1);
+    std::vector<char> pageSaved(config.pageCount);
+    Workload pageWorkload(config.pageCount);
+    pageWorkload.setCancellationToken(config.cancellationToken);
+    pageWorkload.setThreadPinning(config.pinThreads && glyphThreadCount == 1);
+    if (config.progress)
+        pageWorkload.setProgressCallback(printProgress);
+    if (!pageWorkload.finish([&pageGlyphs, &pageSaved, &config, pageThreadCount, glyphThreadCount](int page, int) -> bool {
+        bool numaAffinity = config.numaAffinity && pageThreadCount == 1;
+        ImmediateAtlasGenerator<S, N, GEN_FN, BitmapAtlasStorage<T, N> > generator(config.width, config.height, glyphThreadCount, numaAffinity);
+        generator.setAttributes(config.generatorAttributes);
+        generator.setThreadCount(glyphThreadCount);
+        generator.setThreadPinning(config.pinThreads && pageThreadCount == 1);
+        generator.setNumaAffinity(numaAffinity);
+        generator.setCancellationToken(config.cancellationToken);
+        generator.generate(pageGlyphs[page].data(), pageGlyphs[page].size());
+        if (isCancelled(config.cancellationToken))
+            return false;
+        msdfgen::BitmapConstRef<T, N> bitmap = (msdfgen::BitmapConstRef<T, N>) generator.atlasStorage();
+        pageSaved[page] = saveImage(bitmap, config.imageFormat, config.pageImageFilenames[page].c_str(), config.yDirection);
+        return true;
+    }, pageThreadCount) && isCancelled(config.cancellationToken)) {
+        fputs("操作已取消。\n", stderr);
+        return false;
+    }
+
+    bool success = true;
+    for (int i = 0; i < config.pageCount; ++i) {
+        if (!pageSaved[i]) {
+            success = false;
+            fprintf(stderr, "无法将图集页面 %d 保存为图像文件。\n", i);
+        }
+    }
+    if (success)
+        fprintf(stderr, "图集图像文件已保存（%d 个页面）。\n", config.pageCount);
+    return success;
+}
+
 template <typename T, typename S, int N, GeneratorFunction<S, N> GEN_FN>
 static bool makeAtlas(const std::vector<GlyphGeometry> &glyphs, const std::vector<FontGeometry> &fonts, const Configuration &config) {
-    ImmediateAtlasGenerator<S, N, GEN_FN, BitmapAtlasStorage<T, N> > generator(config.width, config.height);
+    if (config.pageCount > 0)
+        return makeAtlasPages<T, S, N, GEN_FN>(glyphs, config);
+    ImmediateAtlasGenerator<S, N, GEN_FN, BitmapAtlasStorage<T, N> > generator(config.width, config.height, config.threadCount, config.numaAffinity);
     generator.setAttributes(config.generatorAttributes);
     generator.setThreadCount(config.threadCount);
+    generator.setThreadPinning(config.pinThreads);
+    generator.setNumaAffinity(config.numaAffinity);
+    generator.setCancellationToken(config.cancellationToken);
+    if (config.progress)
+        generator.setProgressCallback(printProgress);
     generator.generate(glyphs.data(), glyphs.size());
+    if (isCancelled(config.cancellationToken)) {
+        fputs("操作已取消。\n", stderr);
+        return false;
+    }
     msdfgen::BitmapConstRef<T, N> bitmap = (msdfgen::BitmapConstRef<T, N>) generator.atlasStorage();
 
     bool success = true;
@@ -396,6 +906,21 @@ static bool makeAtlas(const std::vector<GlyphGeometry> &glyphs, const std::vecto
         }
     }
 
+    if (config.textureArrayFilename) {
+        TextureArrayExportProperties texArrayProps;
+        texArrayProps.cellWidth = config.grid.cellWidth, texArrayProps.cellHeight = config.grid.cellHeight;
+        texArrayProps.columns = config.grid.cols;
+        texArrayProps.compression = config.textureArrayCompression;
+        texArrayProps.yDirection = config.yDirection;
+        texArrayProps.threadCount = config.threadCount;
+        if (exportTextureArray(glyphs.data(), glyphs.size(), bitmap, config.textureArrayFilename, texArrayProps))
+            fputs("纹理数组文件已保存。\n", stderr);
+        else {
+            success = false;
+            fputs("无法保存纹理数组文件。\n", stderr);
+        }
+    }
+
 #ifndef MSDF_ATLAS_NO_ARTERY_FONT
     if (config.arteryFontFilename) {
         ArteryFontExportProperties arfontProps;
@@ -441,6 +966,15 @@ int main(int argc, const char *const *argv) {
     // 添加一个变量来存储从命令行解析的间距值。
     // 初始化为 -1 表示用户没有通过命令行指定该值。
     int packingSpacing = -1;
+    bool packingPortfolio = false;
+    bool anyAspectAtlas = false;
+    int maxAtlasWidth = 0, maxAtlasHeight = 0;
+    const char *gpuProfileName = nullptr;
+    GpuMemoryModel gpuMemoryModel = { };
+    bool gpuCompressedFormat = false;
+    bool fastPacking = false;
+    int packingPartitions = 0;
+    bool packingRotation = false;
 
     config.preprocessGeometry = (
         #ifdef MSDFGEN_USE_SKIA
@@ -452,6 +986,7 @@ int main(int argc, const char *const *argv) {
     config.generatorAttributes.config.overlapSupport = !config.preprocessGeometry;
     config.generatorAttributes.scanlinePass = !config.preprocessGeometry;
     double minEmSize = 0;
+    double scaleHint = 0;
     Units rangeUnits = Units::PIXELS;
     msdfgen::Range rangeValue = 0;
     Padding innerPadding;
@@ -465,6 +1000,11 @@ int main(int argc, const char *const *argv) {
     config.miterLimit = DEFAULT_MITER_LIMIT;
     config.pxAlignOriginX = false, config.pxAlignOriginY = true;
     config.threadCount = 0;
+    const char *glyphWeightsFilename = nullptr;
+    double hotCoverage = 0;
+    const char *pageGroupsSpec = nullptr;
+    unsigned pageMaxGlyphs = 0;
+    const char *pageIndexFilename = nullptr;
 
     // Parse command line // 解析命令行
     int argPos = 1;
@@ -538,6 +1078,7 @@ int main(int argc, const char *const *argv) {
         ARG_CASE("-font", 1) {
             fontInput.fontFilename = argv[argPos++];
             fontInput.variableFont = false;
+            fontInput.varInstances = nullptr;
             continue;
         }
     #ifndef MSDFGEN_DISABLE_VARIABLE_FONTS
@@ -546,37 +1087,70 @@ int main(int argc, const char *const *argv) {
             fontInput.variableFont = true;
             continue;
         }
+        ARG_CASE("-varinstances", 1) {
+            fontInput.varInstances = argv[argPos++];
+            continue;
+        }
     #endif
         ARG_CASE("-charset", 1) {
             fontInput.charsetFilename = argv[argPos++];
             fontInput.charsetString = nullptr;
+            fontInput.corpusFilenames = nullptr, fontInput.corpusFileCount = 0;
             fontInput.glyphIdentifierType = GlyphIdentifierType::UNICODE_CODEPOINT;
             continue;
         }
         ARG_CASE("-glyphset", 1) {
             fontInput.charsetFilename = argv[argPos++];
             fontInput.charsetString = nullptr;
+            fontInput.corpusFilenames = nullptr, fontInput.corpusFileCount = 0;
             fontInput.glyphIdentifierType = GlyphIdentifierType::GLYPH_INDEX;
             continue;
         }
         ARG_CASE("-chars", 1) {
             fontInput.charsetFilename = nullptr;
             fontInput.charsetString = argv[argPos++];
+            fontInput.corpusFilenames = nullptr, fontInput.corpusFileCount = 0;
             fontInput.glyphIdentifierType = GlyphIdentifierType::UNICODE_CODEPOINT;
             continue;
         }
         ARG_CASE("-glyphs", 1) {
             fontInput.charsetFilename = nullptr;
             fontInput.charsetString = argv[argPos++];
+            fontInput.corpusFilenames = nullptr, fontInput.corpusFileCount = 0;
             fontInput.glyphIdentifierType = GlyphIdentifierType::GLYPH_INDEX;
             continue;
         }
         ARG_CASE("-allglyphs", 0) {
             fontInput.charsetFilename = nullptr;
             fontInput.charsetString = nullptr;
+            fontInput.corpusFilenames = nullptr, fontInput.corpusFileCount = 0;
             fontInput.glyphIdentifierType = GlyphIdentifierType::GLYPH_INDEX;
             continue;
         }
+        ARG_CASE("-charsetfromtext", 1) {
+            fontInput.charsetFilename = nullptr;
+            fontInput.charsetString = nullptr;
+            fontInput.glyphIdentifierType = GlyphIdentifierType::UNICODE_CODEPOINT;
+            fontInput.corpusFilenames = argv+argPos;
+            fontInput.corpusFileCount = 0;
+            while (argPos < argc && (!fontInput.corpusFileCount || argv[argPos][0] != '-'))
+                ++fontInput.corpusFileCount, ++argPos;
+            continue;
+        }
+        ARG_CASE("-charsettop", 1) {
+            unsigned n;
+            if (!(parseUnsigned(n, argv[argPos++]) && n))
+                ABORT("无效的字符数量。请使用 -charsettop <N> 并指定一个正整数。");
+            fontInput.corpusTop = n;
+            continue;
+        }
+        ARG_CASE("-charsetcoverage", 1) {
+            double p;
+            if (!(parseDouble(p, argv[argPos++]) && p > 0 && p <= 100))
+                ABORT("无效的覆盖率。请使用 -charsetcoverage <百分比> 并指定一个 0 到 100 之间的实数。");
+            fontInput.corpusCoverage = .01*p;
+            continue;
+        }
         ARG_CASE("-fontscale", 1) {
             double fs;
             if (!(parseDouble(fs, argv[argPos++]) && fs > 0))
@@ -589,12 +1163,13 @@ int main(int argc, const char *const *argv) {
             continue;
         }
         ARG_CASE("-and", 0) {
-            if (!fontInput.fontFilename && !fontInput.charsetFilename && !fontInput.charsetString && fontInput.fontScale < 0)
+            if (!fontInput.fontFilename && !fontInput.charsetFilename && !fontInput.charsetString && !fontInput.corpusFilenames && fontInput.fontScale < 0)
                 ABORT("-and 分隔符之前未指定字体、字符集或字体缩放比例。");
             if (!fontInputs.empty() && !memcmp(&fontInputs.back(), &fontInput, sizeof(FontInput)))
                 ABORT("后续输入之间没有变化。必须在 -and 分隔符之间设置不同的字体、字符集或字体缩放比例。");
             fontInputs.push_back(fontInput);
             fontInput.fontName = nullptr;
+            fontInput.varInstances = nullptr;
             continue;
         }
     #ifndef MSDF_ATLAS_NO_ARTERY_FONT
@@ -615,6 +1190,24 @@ int main(int argc, const char *const *argv) {
             config.csvFilename = argv[argPos++];
             continue;
         }
+        ARG_CASE("-texarray", 1) {
+            config.textureArrayFilename = argv[argPos++];
+            continue;
+        }
+        ARG_CASE("-texarraycompression", 1) {
+            if (ARG_IS("none"))
+                config.textureArrayCompression = TextureArrayCompression::NONE;
+            else if (ARG_IS("bc4"))
+                config.textureArrayCompression = TextureArrayCompression::BC4;
+            else
+                ABORT("未知的纹理数组压缩格式。请使用 -texarraycompression 并指定以下之一：none, bc4.");
+            ++argPos;
+            continue;
+        }
+        ARG_CASE("-pageindex", 1) {
+            pageIndexFilename = argv[argPos++];
+            continue;
+        }
         ARG_CASE("-shadronpreview", 2) {
             config.shadronPreviewFilename = argv[argPos++];
             config.shadronPreviewText = argv[argPos++];
@@ -660,6 +1253,89 @@ int main(int argc, const char *const *argv) {
             fixedWidth = -1, fixedHeight = -1;
             continue;
         }
+        ARG_CASE("-rect", 0) {
+            atlasSizeConstraint = DimensionsConstraint::NONE;
+            anyAspectAtlas = true;
+            fixedWidth = -1, fixedHeight = -1;
+            continue;
+        }
+        ARG_CASE("-maxdimensions", 2) {
+            unsigned w, h;
+            if (!(parseUnsigned(w, argv[argPos++]) && parseUnsigned(h, argv[argPos++])))
+                ABORT("无效的最大图集尺寸。请使用 -maxdimensions <宽度> <高度> 并指定两个非负整数。");
+            maxAtlasWidth = w, maxAtlasHeight = h;
+            continue;
+        }
+        ARG_CASE("-gpuprofile", 1) {
+            gpuProfileName = argv[argPos++];
+            if (!getGpuMemoryProfile(gpuMemoryModel.profile, gpuProfileName))
+                ABORT("未知的显存平台配置。请使用 -gpuprofile <generic / d3d12 / tiled / pot>。");
+            atlasSizeConstraint = DimensionsConstraint::MINIMUM_MEMORY;
+            fixedWidth = -1, fixedHeight = -1;
+            continue;
+        }
+        ARG_CASE("-gpuformat", 1) {
+            if (!getGpuTextureFormat(gpuMemoryModel.format, argv[argPos++]))
+                ABORT("未知的压缩纹理格式。请使用 -gpuformat <bc1 / bc4 / bc5 / bc7 / etc2 / astc4x4 / astc6x6 / astc8x8>。");
+            gpuCompressedFormat = true;
+            continue;
+        }
+        ARG_CASE("-gpualignment", 4) {
+            unsigned rowPitch, tileWidth, tileHeight, allocation;
+            if (!(parseUnsigned(rowPitch, argv[argPos++]) && parseUnsigned(tileWidth, argv[argPos++]) && parseUnsigned(tileHeight, argv[argPos++]) && parseUnsigned(allocation, argv[argPos++])))
+                ABORT("无效的显存对齐规则。请使用 -gpualignment <行跨距字节数> <分块宽度> <分块高度> <分配对齐字节数> 并指定非负整数。");
+            if (!gpuProfileName) {
+                gpuProfileName = "custom";
+                atlasSizeConstraint = DimensionsConstraint::MINIMUM_MEMORY;
+                fixedWidth = -1, fixedHeight = -1;
+            }
+            gpuMemoryModel.profile.rowPitchAlignment = (int) rowPitch;
+            gpuMemoryModel.profile.tileWidth = (int) tileWidth;
+            gpuMemoryModel.profile.tileHeight = (int) tileHeight;
+            gpuMemoryModel.profile.allocationAlignment = (int) allocation;
+            continue;
+        }
+        ARG_CASE("-packportfolio", 0) {
+            packingPortfolio = true;
+            continue;
+        }
+        ARG_CASE("-fastpack", 0) {
+            fastPacking = true;
+            continue;
+        }
+        ARG_CASE("-partitions", 1) {
+            unsigned n;
+            if (!(parseUnsigned(n, argv[argPos++]) && (int) n >= 0))
+                ABORT("无效的分区数。请使用 -partitions <N> 并指定 N 为一个非负整数。");
+            packingPartitions = (int) n;
+            continue;
+        }
+        ARG_CASE("-allowrotation", 0) {
+            packingRotation = true;
+            continue;
+        }
+        ARG_CASE("-glyphweights", 1) {
+            glyphWeightsFilename = argv[argPos++];
+            continue;
+        }
+        ARG_CASE("-hotcoverage", 1) {
+            double p;
+            if (!(parseDouble(p, argv[argPos++]) && p > 0 && p <= 100))
+                ABORT("无效的热区覆盖率。请使用 -hotcoverage <百分比> 并指定一个 0 到 100 之间的实数。");
+            hotCoverage = .01*p;
+            continue;
+        }
+        ARG_CASE("-pagegroups", 1) {
+            pageGroupsSpec = argv[argPos++];
+            continue;
+        }
+        ARG_CASE("-pagemaxglyphs", 1) {
+            unsigned n;
+            if (!(parseUnsigned(n, argv[argPos++]) && n > 0))
+                ABORT("无效的页面字形数量。请使用 -pagemaxglyphs <N> 并指定一个正整数。");
+            pageMaxGlyphs = n;
+            continue;
+        }
         ARG_CASE("-yorigin", 1) {
             if (ARG_IS("bottom"))
                 config.yDirection = YDirection::BOTTOM_UP;
@@ -684,6 +1360,13 @@ int main(int argc, const char *const *argv) {
             minEmSize = s;
             continue;
         }
+        ARG_CASE("-scalehint", 1) {
+            double s;
+            if (!(parseDouble(s, argv[argPos++]) && s > 0))
+                ABORT("无效的尺寸提示参数。请使用 -scalehint <em 尺寸> 并指定一个正实数。");
+            scaleHint = s;
+            continue;
+        }
         ARG_CASE("-emrange", 1) {
             double r;
             if (!(parseDouble(r, argv[argPos++]) && r != 0))
@@ -844,6 +1527,11 @@ int main(int argc, const char *const *argv) {
             ++argPos;
             continue;
         }
+        ARG_CASE("-variablegrid", 0) {
+            packingStyle = PackingStyle::GRID;
+            config.grid.variableWidths = true;
+            continue;
+        }
         ARG_CASE("-uniformorigin", 1) {
             packingStyle = PackingStyle::GRID;
             if (ARG_IS("off") || ARG_PREFIX("disable") || ARG_IS("0") || ARG_IS("false") || ARG_PREFIX("n"))
@@ -971,6 +1659,26 @@ int main(int argc, const char *const *argv) {
             config.threadCount = (int) tc;
             continue;
         }
+        ARG_CASE("-simd", 1) {
+            SimdLevel simdLevel;
+            if (!parseSimdLevel(simdLevel, argv[argPos++]))
+                ABORT("无效的指令集级别。请使用 -simd <scalar / sse4.1 / avx2 / avx512 / neon>。");
+            if (!setSimdLevel(simdLevel))
+                ABORT("当前 CPU 或构建不支持所选的指令集级别。");
+            continue;
+        }
+        ARG_CASE("-numa", 0) {
+            config.numaAffinity = true;
+            continue;
+        }
+        ARG_CASE("-pinthreads", 0) {
+            config.pinThreads = true;
+            continue;
+        }
+        ARG_CASE("-progress", 0) {
+            config.progress = true;
+            continue;
+        }
         ARG_CASE("-version", 0) {
             puts(versionText);
             return 0;
@@ -1000,20 +1708,24 @@ int main(int argc, const char *const *argv) {
     }
     if (!fontInput.fontFilename)
         ABORT("未指定字体文件。");
-    if (!(config.arteryFontFilename || config.imageFilename || config.jsonFilename || config.csvFilename || config.shadronPreviewFilename)) {
+    if (!(config.arteryFontFilename || config.imageFilename || config.textureArrayFilename || config.jsonFilename || config.csvFilename || config.shadronPreviewFilename || pageIndexFilename)) {
         fputs("未指定输出文件。\n", stderr);
         return 0;
     }
-    bool layoutOnly = !(config.arteryFontFilename || config.imageFilename);
+    bool layoutOnly = !(config.arteryFontFilename || config.imageFilename || config.textureArrayFilename);
 
     // Finalize font inputs // 完成字体输入
     const FontInput *nextFontInput = &fontInput;
     for (std::vector<FontInput>::reverse_iterator it = fontInputs.rbegin(); it != fontInputs.rend(); ++it) {
         if (!it->fontFilename && nextFontInput->fontFilename)
             it->fontFilename = nextFontInput->fontFilename;
-        if (!(it->charsetFilename || it->charsetString || it->glyphIdentifierType == GlyphIdentifierType::GLYPH_INDEX) && (nextFontInput->charsetFilename || nextFontInput->charsetString || nextFontInput->glyphIdentifierType == GlyphIdentifierType::GLYPH_INDEX)) {
+        if (!(it->charsetFilename || it->charsetString || it->corpusFilenames || it->glyphIdentifierType == GlyphIdentifierType::GLYPH_INDEX) && (nextFontInput->charsetFilename || nextFontInput->charsetString || nextFontInput->corpusFilenames || nextFontInput->glyphIdentifierType == GlyphIdentifierType::GLYPH_INDEX)) {
             it->charsetFilename = nextFontInput->charsetFilename;
             it->charsetString = nextFontInput->charsetString;
+            it->corpusFilenames = nextFontInput->corpusFilenames;
+            it->corpusFileCount = nextFontInput->corpusFileCount;
+            it->corpusTop = nextFontInput->corpusTop;
+            it->corpusCoverage = nextFontInput->corpusCoverage;
             it->glyphIdentifierType = nextFontInput->glyphIdentifierType;
         }
         if (it->fontScale < 0 && nextFontInput->fontScale >= 0)
@@ -1024,8 +1736,16 @@ int main(int argc, const char *const *argv) {
         fontInputs.push_back(fontInput);
 
     // Fix up configuration based on related values // 根据相关值修复配置
-    if (packingStyle == PackingStyle::TIGHT && atlasSizeConstraint == DimensionsConstraint::NONE)
+    if (packingStyle == PackingStyle::TIGHT && atlasSizeConstraint == DimensionsConstraint::NONE && !anyAspectAtlas)
         atlasSizeConstraint = DimensionsConstraint::MULTIPLE_OF_FOUR_SQUARE;
+    if (config.grid.variableWidths && config.grid.fixedOriginX)
+        ABORT("可变宽度网格要求字形原点在水平方向不固定。请使用 -uniformorigin off 或 vertical。");
+    if (config.textureArrayFilename) {
+        if (packingStyle != PackingStyle::GRID || config.grid.variableWidths)
+            ABORT("纹理数组输出需要均匀网格布局（-uniformgrid），且不支持可变宽度网格。");
+        if (config.textureArrayCompression == TextureArrayCompression::BC4 && (config.imageType == ImageType::MSDF || config.imageType == ImageType::MTSDF))
+            ABORT("BC4 压缩仅支持单通道图集类型。");
+    }
     if (!(config.imageType == ImageType::PSDF || config.imageType == ImageType::MSDF || config.imageType == ImageType::MTSDF))
         config.miterLimit = 0;
     if (config.emSize > minEmSize)
@@ -1044,7 +1764,7 @@ int main(int argc, const char *const *argv) {
     if (config.kerning && !(config.arteryFontFilename || config.jsonFilename || config.shadronPreviewFilename))
         config.kerning = false;
     if (config.threadCount <= 0)
-        config.threadCount = std::max((int) std::thread::hardware_concurrency(), 1);
+        config.threadCount = getDefaultThreadCount();
     if (config.generatorAttributes.scanlinePass) {
         if (explicitErrorCorrectionMode && config.generatorAttributes.config.errorCorrection.distanceCheckMode != msdfgen::ErrorCorrectionConfig::DO_NOT_CHECK_DISTANCE) {
             const char *fallbackModeName = "unknown";
@@ -1059,6 +1779,27 @@ int main(int argc, const char *const *argv) {
         config.generatorAttributes.config.errorCorrection.distanceCheckMode = msdfgen::ErrorCorrectionConfig::DO_NOT_CHECK_DISTANCE;
     }
 
+    if (gpuCompressedFormat && !gpuProfileName)
+        ABORT("-gpuformat 需要通过 -gpuprofile 或 -gpualignment 指定显存模型。");
+
+    // Paged atlas // 分页图集
+    std::vector<Charset> pageGroups;
+    if (pageIndexFilename && !pageGroupsSpec)
+        ABORT("-pageindex 需要通过 -pagegroups 启用分页模式。");
+    if (pageGroupsSpec) {
+        if (packingStyle != PackingStyle::TIGHT)
+            ABORT("分页模式不支持均匀网格布局。");
+        if (config.arteryFontFilename || config.csvFilename || config.shadronPreviewFilename)
+            ABORT("分页模式不支持 Artery Font、CSV 和 Shadron 预览输出。");
+        if (strcmp(pageGroupsSpec, "blocks") && !loadPageGroups(pageGroups, pageGroupsSpec))
+            ABORT("无法加载页面分组文件。");
+        // All pages share a single glyph scale // 所有页面共享相同的字形缩放
+        if (!(minEmSize > 0)) {
+            fputs("分页模式需要指定字形尺寸，使用默认值...\n", stderr);
+            minEmSize = DEFAULT_SIZE;
+        }
+    }
+
     // Finalize image format // 完成图像格式
     ImageFormat imageExtension = ImageFormat::UNSPECIFIED;
     if (config.imageFilename) {
@@ -1099,9 +1840,9 @@ int main(int argc, const char *const *argv) {
         fputs("错误：无法使用指定的图像格式创建 Artery Font 文件！\n", stderr);
         // Recheck whether there is anything else to do
         // 重新检查是否还有其他事情要做
-        if (!(config.arteryFontFilename || config.imageFilename || config.jsonFilename || config.csvFilename || config.shadronPreviewFilename))
+        if (!(config.arteryFontFilename || config.imageFilename || config.textureArrayFilename || config.jsonFilename || config.csvFilename || config.shadronPreviewFilename))
             return result;
-        layoutOnly = !(config.arteryFontFilename || config.imageFilename);
+        layoutOnly = !(config.arteryFontFilename || config.imageFilename || config.textureArrayFilename);
     }
 #endif
     if (imageExtension != ImageFormat::UNSPECIFIED) {
@@ -1142,12 +1883,19 @@ int main(int argc, const char *const *argv) {
         spacing = -1;// 对于其他类型（ MASK 等），默认间距为 -1（这是打包器内部的一个特殊标志，我们保留它以确保行为一致）。
     }
     double uniformOriginX, uniformOriginY;
+    std::vector<int> gridRowLengths, gridRowCellWidths;
+    Rectangle hotRegion = { };
 
     // Load fonts // 加载字体
     std::vector<GlyphGeometry> glyphs;
     std::vector<FontGeometry> fonts;
     bool anyCodepointsAvailable = false;
+    // Codepoint frequencies of all scanned text corpora // 所有已扫描文本语料库的码位频率
+    TextCorpus corpus;
     {
+        const char *const *scannedCorpusFilenames = nullptr;
+        TextCorpus inputCorpus;
+
         class FontHolder {
             msdfgen::FreetypeHandle *ft;
             msdfgen::FontHandle *font;
@@ -1186,7 +1934,9 @@ int main(int argc, const char *const *argv) {
         } font;
 
         for (FontInput &fontInput : fontInputs) {
-            if (!font.load(fontInput.fontFilename, fontInput.variableFont))
+            if (fontInput.varInstances && !fontInput.variableFont)
+                ABORT("-varinstances 只能与 -varfont 一起使用。");
+            if (!fontInput.varInstances && !font.load(fontInput.fontFilename, fontInput.variableFont))
                 ABORT("无法加载指定的字体文件。");
             if (fontInput.fontScale <= 0)
                 fontInput.fontScale = 1;
@@ -1200,11 +1950,127 @@ int main(int argc, const char *const *argv) {
             } else if (fontInput.charsetString) {
                 if (!charset.parse(fontInput.charsetString, strlen(fontInput.charsetString), fontInput.glyphIdentifierType != GlyphIdentifierType::UNICODE_CODEPOINT))
                     ABORT(fontInput.glyphIdentifierType == GlyphIdentifierType::GLYPH_INDEX ? "无法解析字形集规范。" : "无法解析字符集规范。");
-            } else if (fontInput.glyphIdentifierType == GlyphIdentifierType::GLYPH_INDEX)
-                msdfgen::getGlyphCount(allGlyphCount, font);
-            else
+            } else if (fontInput.corpusFilenames) {
+                if (fontInput.corpusFilenames != scannedCorpusFilenames) {
+                    inputCorpus = TextCorpus();
+                    if (!inputCorpus.scanFiles(fontInput.corpusFilenames, fontInput.corpusFileCount, config.threadCount))
+                        ABORT("无法读取文本语料库文件。");
+                    corpus.merge(inputCorpus);
+                    scannedCorpusFilenames = fontInput.corpusFilenames;
+                    printf("已扫描文本语料库：%llu 个字符，%d 个不同码位。\n", inputCorpus.getTotal(), (int) inputCorpus.getCodepointCount());
+                }
+                double coverage = inputCorpus.getCharset(charset, fontInput.corpusTop, fontInput.corpusCoverage > 0 ? fontInput.corpusCoverage : 1);
+                if (fontInput.corpusTop || fontInput.corpusCoverage > 0)
+                    printf("从语料库中选择了 %d 个最常用的码位，覆盖 %.4g%% 的文本。\n", (int) charset.size(), 100*coverage);
+                if (charset.empty())
+                    ABORT("文本语料库中没有任何字符。");
+            } else if (fontInput.glyphIdentifierType == GlyphIdentifierType::GLYPH_INDEX) {
+                if (!fontInput.varInstances)
+                    msdfgen::getGlyphCount(allGlyphCount, font);
+            } else
                 charset = Charset::ASCII;
 
+        #ifndef MSDFGEN_DISABLE_VARIABLE_FONTS
+            // Load all instances of a variable font in a single parallel pass, each as a separate variant
+            // 在一次并行处理中加载可变字体的所有实例，每个实例作为一个单独的变体
+            if (fontInput.varInstances) {
+                std::vector<std::string> instanceSpecs;
+                for (const char *spec = fontInput.varInstances; *spec; ) {
+                    std::string instanceSpec;
+                    while (*spec && *spec != ',')
+                        instanceSpec.push_back(*spec++);
+                    if (*spec == ',')
+                        ++spec;
+                    if (!instanceSpec.empty())
+                        instanceSpecs.push_back((std::string &&) instanceSpec);
+                }
+                if (instanceSpecs.empty())
+                    ABORT("未指定可变字体实例。");
+                VarFontInstances instances;
+                if (!instances.load(fontInput.fontFilename, instanceSpecs, config.threadCount))
+                    ABORT("无法加载可变字体实例。请使用标准字重名称或 轴=值&轴=值 形式的坐标。");
+                if (fontInput.glyphIdentifierType == GlyphIdentifierType::GLYPH_INDEX && !(fontInput.charsetFilename || fontInput.charsetString))
+                    msdfgen::getGlyphCount(allGlyphCount, instances.face(0, 0));
+                bool byIndex = fontInput.glyphIdentifierType == GlyphIdentifierType::GLYPH_INDEX;
+                // All instances share the same set of glyphs to load
+                // 所有实例共用同一组要加载的字形
+                std::vector<unicode_t> identifiers;
+                if (allGlyphCount) {
+                    identifiers.resize(allGlyphCount);
+                    for (unsigned i = 0; i < allGlyphCount; ++i)
+                        identifiers[i] = i;
+                } else
+                    identifiers.assign(charset.begin(), charset.end());
+                int instanceCount = (int) instances.size();
+                std::vector<FontGeometry> instanceGeometries(instanceCount);
+                for (int i = 0; i < instanceCount; ++i) {
+                    // Loading an empty set only sets up the metrics, geometry scale and identifier type of the instance
+                    int result = byIndex ?
+                        instanceGeometries[i].loadGlyphset(instances.face(0, i), fontInput.fontScale, Charset(), config.preprocessGeometry, false) :
+                        instanceGeometries[i].loadCharset(instances.face(0, i), fontInput.fontScale, Charset(), config.preprocessGeometry, false);
+                    if (result < 0)
+                        ABORT("无法从字体加载字形。");
+                }
+                // Split the glyphs into ranges and schedule the ranges of all instances together, each thread using its own faces
+                // 将字形划分为若干范围，并统一调度所有实例的范围，每个线程使用自己的字体实例
+                int glyphCount = (int) identifiers.size();
+                int rangeSize = std::max((int) (((long long) glyphCount*instanceCount+4*config.threadCount-1)/(4*config.threadCount)), 16);
+                int rangeCount = (glyphCount+rangeSize-1)/rangeSize;
+                std::vector<std::vector<GlyphGeometry> > rangeGlyphs((size_t) instanceCount*rangeCount);
+                if (!Workload(instanceCount*rangeCount).finish([&instances, &instanceGeometries, &rangeGlyphs, &identifiers, byIndex, glyphCount, rangeSize, rangeCount, &config](int chunk, int threadNo) -> bool {
+                    int instance = chunk/rangeCount;
+                    int start = chunk%rangeCount*rangeSize;
+                    int end = std::min(start+rangeSize, glyphCount);
+                    msdfgen::FontHandle *face = instances.face(threadNo, instance);
+                    if (!face)
+                        return false;
+                    double geometryScale = instanceGeometries[instance].getGeometryScale();
+                    std::vector<GlyphGeometry> &loaded = rangeGlyphs[chunk];
+                    for (int i = start; i < end; ++i) {
+                        GlyphGeometry glyph;
+                        if (byIndex ? glyph.load(face, geometryScale, msdfgen::GlyphIndex(identifiers[i]), config.preprocessGeometry) : glyph.load(face, geometryScale, identifiers[i], config.preprocessGeometry))
+                            loaded.push_back((GlyphGeometry &&) glyph);
+                    }
+                    return true;
+                }, config.threadCount))
+                    ABORT("无法加载可变字体实例。");
+                std::vector<int> instanceGlyphsLoaded(instanceCount, 0);
+                for (int i = 0; i < instanceCount; ++i) {
+                    for (int j = 0; j < rangeCount; ++j) {
+                        for (GlyphGeometry &glyph : rangeGlyphs[(size_t) i*rangeCount+j]) {
+                            instanceGeometries[i].addGlyph((GlyphGeometry &&) glyph);
+                            ++instanceGlyphsLoaded[i];
+                        }
+                        std::vector<GlyphGeometry>().swap(rangeGlyphs[(size_t) i*rangeCount+j]);
+                    }
+                }
+                if (config.kerning) {
+                    if (!Workload(instanceCount).finish([&instances, &instanceGeometries](int i, int threadNo) -> bool {
+                        msdfgen::FontHandle *face = instances.face(threadNo, i);
+                        if (!face)
+                            return false;
+                        instanceGeometries[i].loadKerning(face);
+                        return true;
+                    }, config.threadCount))
+                        ABORT("无法加载可变字体实例。");
+                }
+                for (int i = 0; i < instanceCount; ++i) {
+                    printf("已加载 %d 个字形中的 %d 个的几何信息（实例 \"%s\"）.\n", instanceGlyphsLoaded[i], glyphCount, instanceSpecs[i].c_str());
+                    if (!byIndex)
+                        anyCodepointsAvailable |= instanceGlyphsLoaded[i] > 0;
+                    FontGeometry &fontGeometry = instanceGeometries[i];
+                    reportMissingGlyphs(fontGeometry, instanceGlyphsLoaded[i], charset, allGlyphCount, fontInput.glyphIdentifierType, instanceSpecs[i].c_str());
+                    fontGeometry.moveGlyphs(&glyphs);
+                    if (fontInput.fontName)
+                        fontGeometry.setName((std::string(fontInput.fontName)+" "+instanceSpecs[i]).c_str());
+                    else
+                        fontGeometry.setName(instanceSpecs[i].c_str());
+                    fonts.push_back((FontGeometry &&) fontGeometry);
+                }
+                continue;
+            }
+        #endif
+
             // Load glyphs // 加载字形
             FontGeometry fontGeometry(&glyphs);
             int glyphsLoaded = -1;
@@ -1227,30 +2093,7 @@ int main(int argc, const char *const *argv) {
                 printf("（来自字体 \"%s\"）", fontInput.fontFilename);
             printf(".\n");
             // List missing glyphs // 列出缺失的字形
-            if (glyphsLoaded < (int) charset.size()) {
-                fprintf(stderr, "缺失 %d 个%s", (int) charset.size()-glyphsLoaded, fontInput.glyphIdentifierType == GlyphIdentifierType::UNICODE_CODEPOINT ? "码位" : "字形");
-                bool first = true;
-                switch (fontInput.glyphIdentifierType) {
-                    case GlyphIdentifierType::GLYPH_INDEX:
-                        for (unicode_t cp : charset)
-                            if (!fontGeometry.getGlyph(msdfgen::GlyphIndex(cp)))
-                                fprintf(stderr, "%c 0x%02X", first ? ((first = false), ':') : ',', cp);
-                        break;
-                    case GlyphIdentifierType::UNICODE_CODEPOINT:
-                        for (unicode_t cp : charset)
-                            if (!fontGeometry.getGlyph(cp))
-                                fprintf(stderr, "%c 0x%02X", first ? ((first = false), ':') : ',', cp);
-                        break;
-                }
-                fprintf(stderr, "\n");
-            } else if (glyphsLoaded < (int) allGlyphCount) {
-                fprintf(stderr, "缺失 %d 个字形", (int) allGlyphCount-glyphsLoaded);
-                bool first = true;
-                for (unsigned i = 0; i < allGlyphCount; ++i)
-                    if (!fontGeometry.getGlyph(msdfgen::GlyphIndex(i)))
-                        fprintf(stderr, "%c 0x%02X", first ? ((first = false), ':') : ',', i);
-                fprintf(stderr, "\n");
-            }
+            reportMissingGlyphs(fontGeometry, glyphsLoaded, charset, allGlyphCount, fontInput.glyphIdentifierType, nullptr);
 
             if (fontInput.fontName)
                 fontGeometry.setName(fontInput.fontName);
@@ -1261,6 +2104,54 @@ int main(int argc, const char *const *argv) {
     if (glyphs.empty())
         ABORT("未加载任何字形。");
 
+    // Determine glyph usage weights from the weights file or text corpus
+    // 根据权重文件或文本语料库确定字形使用权重
+    std::vector<double> glyphWeights;
+    if (glyphWeightsFilename || hotCoverage > 0) {
+        if (packingStyle == PackingStyle::TIGHT) {
+            std::map<int, double> weightsByIdentifier;
+            if (glyphWeightsFilename && !loadGlyphWeights(weightsByIdentifier, glyphWeightsFilename))
+                ABORT("无法加载字形权重文件。");
+            if (!glyphWeightsFilename && !corpus.getTotal())
+                ABORT("没有可用的字形权重。请使用 -glyphweights 或 -charsetfromtext 指定字形的使用频率。");
+            glyphWeights.resize(glyphs.size());
+            for (const FontGeometry &font : fonts) {
+                for (const GlyphGeometry &glyph : font.getGlyphs()) {
+                    double &weight = glyphWeights[&glyph-glyphs.data()];
+                    if (glyphWeightsFilename) {
+                        std::map<int, double>::const_iterator it = weightsByIdentifier.find(glyph.getIdentifier(font.getPreferredIdentifierType()));
+                        if (it != weightsByIdentifier.end())
+                            weight = it->second;
+                    } else
+                        weight = (double) corpus.getFrequency(glyph.getCodepoint());
+                }
+            }
+            if (!(hotCoverage > 0))
+                hotCoverage = DEFAULT_HOT_COVERAGE;
+        } else
+            fputs("警告：均匀网格模式不支持热区，字形权重将被忽略。\n", stderr);
+    }
+
+    // Assign glyphs to atlas pages // 将字形分配到图集页面
+    std::vector<std::string> pageNames, pageImageFilenames;
+    if (pageGroupsSpec) {
+        config.pageCount = assignGlyphPages(glyphs, pageNames, pageGroups, glyphWeights, hotCoverage, pageMaxGlyphs);
+        if (config.pageCount < 0)
+            ABORT("分页模式需要由字符集加载的字形（码位）。");
+        // The most used glyphs already form the first page // 最常用的字形已组成第一个页面
+        glyphWeights.clear();
+        if (config.imageFilename) {
+            for (int i = 0; i < config.pageCount; ++i)
+                pageImageFilenames.push_back(pageFilename(config.imageFilename, i));
+            config.pageImageFilenames = pageImageFilenames.data();
+        }
+    }
+
+    // From here on, Ctrl+C cancels the build at the next chunk of work
+    // 从这里开始，Ctrl+C 会在下一个工作块处取消生成
+    config.cancellationToken = &interruptToken;
+    signal(SIGINT, interruptHandler);
+
     // Determine final atlas dimensions, scale and range, pack glyphs
     // 确定最终的图集尺寸、缩放和范围，打包字形
     {
@@ -1292,6 +2183,11 @@ int main(int argc, const char *const *argv) {
                 break;
         }
         bool fixedDimensions = fixedWidth >= 0 && fixedHeight >= 0;
+        if (gpuProfileName && !gpuCompressedFormat) {
+            // Uncompressed texel of the atlas - there are no 3-channel GPU formats, so MSDF is stored in 4 channels
+            int channels = config.imageType == ImageType::MSDF || config.imageType == ImageType::MTSDF ? 4 : 1;
+            gpuMemoryModel.format = GpuTextureFormat { 1, 1, channels*(floatingPointFormat ? 4 : 1) };
+        }
         bool fixedScale = config.emSize > 0;
         switch (packingStyle) {
 
@@ -1299,13 +2195,18 @@ int main(int argc, const char *const *argv) {
                 TightAtlasPacker atlasPacker;
                 if (fixedDimensions)
                     atlasPacker.setDimensions(fixedWidth, fixedHeight);
-                else
+                else {
                     atlasPacker.setDimensionsConstraint(atlasSizeConstraint);
+                    atlasPacker.setMaximumDimensions(maxAtlasWidth, maxAtlasHeight);
+                    atlasPacker.setMemoryModel(gpuMemoryModel);
+                }
                 atlasPacker.setSpacing(spacing);
                 if (fixedScale)
                     atlasPacker.setScale(config.emSize);
-                else
+                else {
                     atlasPacker.setMinimumScale(minEmSize);
+                    atlasPacker.setScaleHint(scaleHint);
+                }
                 atlasPacker.setPixelRange(pxRange);
                 atlasPacker.setUnitRange(emRange);
                 atlasPacker.setMiterLimit(config.miterLimit);
@@ -1314,8 +2215,51 @@ int main(int argc, const char *const *argv) {
                 atlasPacker.setOuterUnitPadding(outerEmPadding);
                 atlasPacker.setInnerPixelPadding(innerPxPadding);
                 atlasPacker.setOuterPixelPadding(outerPxPadding);
+                atlasPacker.setCancellationToken(&interruptToken);
+                atlasPacker.setHeuristicPortfolio(packingPortfolio);
+                atlasPacker.setFastPacking(fastPacking);
+                atlasPacker.setPartitionCount(packingPartitions);
+                atlasPacker.setRotationAllowed(packingRotation);
+                atlasPacker.setThreadCount(config.threadCount);
+                if (!glyphWeights.empty())
+                    atlasPacker.setGlyphWeights(glyphWeights.data(), (int) glyphWeights.size(), hotCoverage);
+                if (config.pageCount > 0) {
+                    // All pages share one glyph scale, which is searched against the most constrained page
+                    // 所有页面共享同一个字形缩放，其针对最受限的页面进行搜索
+                    if (!fixedScale) {
+                        bool sized = fixedDimensions;
+                        if (!fixedDimensions) {
+                            // The shared dimensions are those of the largest page packed at the minimum scale
+                            // 共享尺寸为以最小缩放打包时最大页面的尺寸
+                            TightAtlasPacker sizingPacker(atlasPacker);
+                            sizingPacker.setScale(minEmSize);
+                            if ((sized = !packAtlasPages(glyphs, config.pageCount, sizingPacker, config.threadCount, config.width, config.height)))
+                                atlasPacker.setDimensions(config.width, config.height);
+                        }
+                        double pageScale = sized ? maximizePageScale(glyphs, config.pageCount, atlasPacker, config.threadCount) : 0;
+                        atlasPacker.setScale(pageScale > 0 ? pageScale : minEmSize);
+                    }
+                    if (int remaining = packAtlasPages(glyphs, config.pageCount, atlasPacker, config.threadCount, config.width, config.height)) {
+                        if (remaining < 0) {
+                            ABORT("无法将字形打包到图集页面中。");
+                        } else {
+                            fprintf(stderr, "错误：无法将 %d 个字形（共 %d 个）放入图集页面。\n", remaining, (int) glyphs.size());
+                            return 1;
+                        }
+                    }
+                    if (!(config.width > 0 && config.height > 0))
+                        ABORT("无法确定图集尺寸。");
+                    config.emSize = atlasPacker.getScale();
+                    config.pxRange = atlasPacker.getPixelRange();
+                    if (!fixedScale)
+                        printf("字形尺寸：%.9g 像素/em\n", config.emSize);
+                    printf("图集页面：%d 个，每页尺寸 %d x %d\n", config.pageCount, config.width, config.height);
+                    break;
+                }
                 if (int remaining = atlasPacker.pack(glyphs.data(), glyphs.size())) {
                     if (remaining < 0) {
+                        if (interruptToken.isCancelled())
+                            ABORT("操作已取消。");
                         ABORT("无法将字形打包到图集中。");
                     } else {
                         fprintf(stderr, "错误：无法将 %d 个字形（共 %d 个）放入图集。\n", remaining, (int) glyphs.size());
@@ -1323,6 +2267,7 @@ int main(int argc, const char *const *argv) {
                     }
                 }
                 atlasPacker.getDimensions(config.width, config.height);
+                hotRegion = atlasPacker.getHotRegion();
                 if (!(config.width > 0 && config.height > 0))
                     ABORT("无法确定图集尺寸。");
                 config.emSize = atlasPacker.getScale();
@@ -1331,6 +2276,16 @@ int main(int argc, const char *const *argv) {
                     printf("字形尺寸：%.9g 像素/em\n", config.emSize);
                 if (!fixedDimensions)
                     printf("图集尺寸：%d x %d\n", config.width, config.height);
+                if (!fixedScale)
+                    printf("尺寸搜索：打包尝试 %d 次\n", atlasPacker.getPackAttemptCount());
+                {
+                    double glyphArea, partitionArea;
+                    atlasPacker.getAreaStatistics(glyphArea, partitionArea);
+                    if (partitionArea > 0 && glyphArea > 0)
+                        printf("分层打包：分区区域面积开销 %.1f%%，图集面积开销 %.1f%%（相对字形总面积）\n", 100*(partitionArea/glyphArea-1), 100*((double) config.width*config.height/glyphArea-1));
+                }
+                if (hotRegion.w > 0 && hotRegion.h > 0)
+                    printf("热区：%d x %d（位于 %d, %d）\n", hotRegion.w, hotRegion.h, hotRegion.x, config.yDirection == YDirection::TOP_DOWN ? config.height-(hotRegion.y+hotRegion.h) : hotRegion.y);
                 break;
             }
 
@@ -1350,8 +2305,10 @@ int main(int argc, const char *const *argv) {
                 atlasPacker.setSpacing(spacing);
                 if (fixedScale)
                     atlasPacker.setScale(config.emSize);
-                else
+                else {
                     atlasPacker.setMinimumScale(minEmSize);
+                    atlasPacker.setScaleHint(scaleHint);
+                }
                 atlasPacker.setPixelRange(pxRange);
                 atlasPacker.setUnitRange(emRange);
                 atlasPacker.setMiterLimit(config.miterLimit);
@@ -1360,8 +2317,13 @@ int main(int argc, const char *const *argv) {
                 atlasPacker.setOuterUnitPadding(outerEmPadding);
                 atlasPacker.setInnerPixelPadding(innerPxPadding);
                 atlasPacker.setOuterPixelPadding(outerPxPadding);
+                atlasPacker.setVariableCellWidths(config.grid.variableWidths);
+                atlasPacker.setThreadCount(config.threadCount);
+                atlasPacker.setCancellationToken(&interruptToken);
                 if (int remaining = atlasPacker.pack(glyphs.data(), glyphs.size())) {
                     if (remaining < 0) {
+                        if (interruptToken.isCancelled())
+                            ABORT("操作已取消。");
                         ABORT("无法将字形打包到图集中。");
                     } else {
                         fprintf(stderr, "错误：无法将 %d 个字形（共 %d 个）放入图集。\n", remaining, (int) glyphs.size());
@@ -1401,11 +2363,33 @@ int main(int argc, const char *const *argv) {
                 }
                 printf("网格单元尺寸：%d x %d\n", config.grid.cellWidth, config.grid.cellHeight);
                 printf("图集尺寸：%d x %d (%d 列 x %d 行)\n", config.width, config.height, config.grid.cols, config.grid.rows);
+                if (config.grid.variableWidths) {
+                    gridRowLengths = atlasPacker.getRowLengths();
+                    gridRowCellWidths = atlasPacker.getRowCellWidths();
+                    long long cellArea = 0, cellCount = 0;
+                    for (size_t i = 0; i < gridRowLengths.size(); ++i) {
+                        cellArea += (long long) gridRowLengths[i]*gridRowCellWidths[i]*config.grid.cellHeight;
+                        cellCount += gridRowLengths[i];
+                    }
+                    int uniformWidth, uniformHeight;
+                    atlasPacker.getUniformDimensions(uniformWidth, uniformHeight);
+                    double uniformCellArea = (double) cellCount*config.grid.cellWidth*config.grid.cellHeight;
+                    double uniformArea = (double) uniformWidth*uniformHeight;
+                    double cellSaving = uniformCellArea > 0 ? 100*(1-cellArea/uniformCellArea) : 0;
+                    double atlasSaving = uniformArea > 0 ? 100*(1-(double) config.width*config.height/uniformArea) : 0;
+                    printf("可变宽度网格：单元格面积节省 %.1f%%，图集面积节省 %.1f%%（均匀网格为 %d x %d）\n", cellSaving, atlasSaving, uniformWidth, uniformHeight);
+                }
+                if (!fixedScale)
+                    printf("尺寸搜索：适配尝试 %d 次\n", atlasPacker.getFitAttemptCount());
                 break;
             }
 
         }
     }
+    if (gpuProfileName && config.width > 0 && config.height > 0) {
+        size_t allocatedBytes = gpuMemoryModel.allocatedBytes(config.width, config.height)*std::max(config.pageCount, 1);
+        printf("显存模型（%s）：图集纹理占用 %.1f KiB\n", gpuProfileName, allocatedBytes/1024.);
+    }
 
     // Generate atlas bitmap  // 生成图集位图
     if (!layoutOnly) {
@@ -1413,18 +2397,22 @@ int main(int argc, const char *const *argv) {
         // Edge coloring // 边缘着色
         if (config.imageType == ImageType::MSDF || config.imageType == ImageType::MTSDF) {
             if (config.expensiveColoring) {
-                Workload([&glyphs, &config](int i, int threadNo) -> bool {
+                Workload((int) glyphs.size()).setCancellationToken(config.cancellationToken).setThreadPinning(config.pinThreads).finish([&glyphs, &config](int i, int threadNo) -> bool {
                     unsigned long long glyphSeed = (LCG_MULTIPLIER*(config.coloringSeed^i)+LCG_INCREMENT)*!!config.coloringSeed;
                     glyphs[i].edgeColoring(config.edgeColoring, config.angleThreshold, glyphSeed);
                     return true;
-                }, glyphs.size()).finish(config.threadCount);
+                }, config.threadCount);
             } else {
                 unsigned long long glyphSeed = config.coloringSeed;
                 for (GlyphGeometry &glyph : glyphs) {
+                    if (interruptToken.isCancelled())
+                        break;
                     glyphSeed *= LCG_MULTIPLIER;
                     glyph.edgeColoring(config.edgeColoring, config.angleThreshold, glyphSeed);
                 }
             }
+            if (interruptToken.isCancelled())
+                ABORT("操作已取消。");
         }
 
         bool success = false;
@@ -1466,7 +2454,7 @@ int main(int argc, const char *const *argv) {
     }
 
     if (config.csvFilename) {
-        if (exportCSV(fonts.data(), fonts.size(), config.width, config.height, config.yDirection, config.csvFilename))
+        if (exportCSV(fonts.data(), fonts.size(), config.width, config.height, config.yDirection, config.csvFilename, hotRegion.w > 0 && hotRegion.h > 0 ? &hotRegion : nullptr, packingRotation))
             fputs("字形布局已写入 CSV 文件。\n", stderr);
         else {
             result = 1;
@@ -1489,8 +2477,16 @@ int main(int argc, const char *const *argv) {
             if (config.grid.fixedOriginY)
                 gridMetrics.originY = &uniformOriginY;
             gridMetrics.spacing = spacing;
+            if (!gridRowLengths.empty()) {
+                gridMetrics.rowLengths = gridRowLengths.data();
+                gridMetrics.rowCellWidths = gridRowCellWidths.data();
+            }
             jsonMetrics.grid = &gridMetrics;
         }
+        if (hotRegion.w > 0 && hotRegion.h > 0)
+            jsonMetrics.hotRegion = &hotRegion;
+        jsonMetrics.pageCount = config.pageCount;
+        jsonMetrics.textureArrayLayers = config.textureArrayFilename != nullptr;
         if (exportJSON(fonts.data(), fonts.size(), config.imageType, jsonMetrics, config.jsonFilename, config.kerning))
             fputs("字形布局和元数据已写入 JSON 文件。\n", stderr);
         else {
@@ -1499,6 +2495,27 @@ int main(int argc, const char *const *argv) {
         }
     }
 
+    if (pageIndexFilename) {
+        std::vector<std::vector<unicode_t> > pageCodepointLists(config.pageCount);
+        for (const GlyphGeometry &glyph : glyphs)
+            pageCodepointLists[glyph.getBoxPage()].push_back(glyph.getCodepoint());
+        std::vector<Charset> pageCodepoints(config.pageCount);
+        for (int i = 0; i < config.pageCount; ++i)
+            pageCodepoints[i].add(pageCodepointLists[i].data(), pageCodepointLists[i].size());
+        std::vector<JsonAtlasPage> pages(config.pageCount);
+        for (int i = 0; i < config.pageCount; ++i) {
+            pages[i].imageFilename = config.pageImageFilenames ? config.pageImageFilenames[i].c_str() : nullptr;
+            pages[i].name = pageNames[i].c_str();
+            pages[i].codepoints = &pageCodepoints[i];
+        }
+        if (exportPageIndexJSON(pages.data(), config.pageCount, config.width, config.height, pageIndexFilename))
+            fputs("图集页面索引已写入 JSON 文件。\n", stderr);
+        else {
+            result = 1;
+            fputs("无法写入页面索引文件。\n", stderr);
+        }
+    }
+
     if (config.shadronPreviewFilename && config.shadronPreviewText) {
         if (anyCodepointsAvailable) {
             std::vector<unicode_t> previewText;
@@ -16,13 +16,20 @@
 #include "Rectangle.h"
 #include "Padding.h"
 #include "Charset.h"
+#include "TextCorpus.h"
+#include "unicode-blocks.h"
 #include "GlyphBox.h"
 #include "GlyphGeometry.h"
 #include "FontGeometry.h"
 #include "RectanglePacker.h"
+#include "ShelfPacker.h"
 #include "rectangle-packing.h"
+#include "CancellationToken.h"
+#include "cpu-topology.h"
 #include "Workload.h"
 #include "size-selectors.h"
+#include "gpu-memory-model.h"
+#include "simd-kernels.h"
 #include "bitmap-blit.h"
 #include "AtlasStorage.h"
 #include "BitmapAtlasStorage.h"
@@ -30,11 +37,16 @@
 #include "GridAtlasPacker.h"
 #include "AtlasGenerator.h"
 #include "ImmediateAtlasGenerator.h"
+#include "DeferredAtlasGenerator.h"
 #include "DynamicAtlas.h"
 #include "glyph-generators.h"
 #include "image-encode.h"
+#include "image-decode.h"
 #include "image-save.h"
 #include "artery-font-export.h"
+#include "artery-font-import.h"
 #include "csv-export.h"
 #include "json-export.h"
+#include "json-import.h"
+#include "texture-array-export.h"
 #include "shadron-preview-generator.h"
@@ -3,9 +3,27 @@
 
 #include <utility>
 #include "Rectangle.h"
+#include "RectanglePacker.h"
+#include "ShelfPacker.h"
 
 namespace msdf_atlas {
 
+/// Order in which rectangles are passed to the packer (all except INPUT are descending)
+enum class PackingOrder {
+    INPUT,
+    HEIGHT,
+    WIDTH,
+    AREA,
+    PERIMETER,
+    MAX_SIDE
+};
+
+/// A combination of rectangle order and fit rule
+struct PackingHeuristic {
+    PackingOrder order;
+    PackingFitRule fitRule;
+};
+
 /// Packs the rectangle array into an atlas with fixed dimensions, returns how many didn't fit (0 on success)
 template <typename RectangleType>
 int packRectangles(RectangleType *rectangles, int count, int width, int height, int spacing = 0);
@@ -14,6 +32,37 @@ int packRectangles(RectangleType *rectangles, int count, int width, int height,
 template <class SizeSelector, typename RectangleType>
 std::pair<int, int> packRectangles(RectangleType *rectangles, int count, int spacing = 0);
 
+/// Packs the rectangle array into an atlas with fixed dimensions using a different packer class (e.g. ShelfPacker), returns how many didn't fit
+template <class Packer, typename RectangleType>
+int packRectangles(RectangleType *rectangles, int count, int width, int height, int spacing);
+
+/// Packs the rectangle array into an atlas of unknown size using a different packer class (e.g. ShelfPacker), returns the minimum required dimensions
+template <class SizeSelector, class Packer, typename RectangleType>
+std::pair<int, int> packRectangles(RectangleType *rectangles, int count, int spacing);
+
+/// Packs the rectangle array into an atlas of unknown size and any aspect ratio, returns the dimensions of minimum area found, which do not exceed maxWidth x maxHeight (if positive).
+/// Each of the aspect ratios (width / height) is searched concurrently, then the width and height of the smallest result are shrunk separately
+template <typename RectangleType>
+std::pair<int, int> packRectanglesMinimumArea(RectangleType *rectangles, int count, int spacing, const double *aspectRatios, int aspectRatioCount, int maxWidth, int maxHeight, int threadCount);
+
+/// Packs the rectangle array into an atlas of unknown size and any aspect ratio using a different packer class (e.g. ShelfPacker)
+template <class Packer, typename RectangleType>
+std::pair<int, int> packRectanglesMinimumArea(RectangleType *rectangles, int count, int spacing, const double *aspectRatios, int aspectRatioCount, int maxWidth, int maxHeight, int threadCount);
+
+/// Like packRectanglesMinimumArea, but minimizes cost(width, height) (e.g. modeled memory), which must not decrease with either dimension
+template <class Packer, class CostFunction, typename RectangleType>
+std::pair<int, int> packRectanglesMinimumCost(RectangleType *rectangles, int count, int spacing, const double *aspectRatios, int aspectRatioCount, int maxWidth, int maxHeight, const CostFunction &cost, int threadCount);
+
+/// Packs the rectangle array into an atlas with fixed dimensions using each of the heuristics concurrently
+/// and keeps the first one in the array with the fewest rectangles that didn't fit, which is returned
+template <typename RectangleType>
+int packRectangles(RectangleType *rectangles, int count, int width, int height, int spacing, const PackingHeuristic *heuristics, int heuristicCount, int threadCount);
+
+/// Packs the rectangle array into an atlas of unknown size using each of the heuristics concurrently for every candidate size,
+/// returns the minimum dimensions achieved by any of them (the first one in the array that fits is kept)
+template <class SizeSelector, typename RectangleType>
+std::pair<int, int> packRectangles(RectangleType *rectangles, int count, int spacing, const PackingHeuristic *heuristics, int heuristicCount, int threadCount);
+
 }
 
 #include "rectangle-packing.hpp"
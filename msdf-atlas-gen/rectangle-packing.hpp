@@ -2,7 +2,10 @@
 #include "rectangle-packing.h"
 
 #include <vector>
+#include <algorithm>
 #include "RectanglePacker.h"
+#include "Workload.h"
+#include "size-selectors.h"
 
 namespace msdf_atlas {
 
@@ -17,14 +20,87 @@ static void copyRectanglePlacement(OrientedRectangle &dst, const OrientedRectang
     dst.rotated = src.rotated;
 }
 
+static int packingOrderKey(const Rectangle &rect, PackingOrder order) {
+    switch (order) {
+        case PackingOrder::HEIGHT:
+            return rect.h;
+        case PackingOrder::WIDTH:
+            return rect.w;
+        case PackingOrder::AREA:
+            return rect.w*rect.h;
+        case PackingOrder::PERIMETER:
+            return rect.w+rect.h;
+        case PackingOrder::MAX_SIDE:
+            return std::max(rect.w, rect.h);
+        default:
+            return 0;
+    }
+}
+
+/// Packs rectangles (which already include spacing) in the order and with the fit rule of the heuristic
+template <typename RectangleType>
+static int packRectanglesWithHeuristic(RectangleType *rectangles, int count, int width, int height, const PackingHeuristic &heuristic) {
+    RectanglePacker packer(width, height);
+    packer.setFitRule(heuristic.fitRule);
+    if (heuristic.order == PackingOrder::INPUT)
+        return packer.pack(rectangles, count);
+    std::vector<int> order(count);
+    for (int i = 0; i < count; ++i)
+        order[i] = i;
+    PackingOrder packingOrder = heuristic.order;
+    std::stable_sort(order.begin(), order.end(), [rectangles, packingOrder](int a, int b) -> bool {
+        return packingOrderKey(rectangles[a], packingOrder) > packingOrderKey(rectangles[b], packingOrder);
+    });
+    std::vector<RectangleType> sorted(count);
+    for (int i = 0; i < count; ++i)
+        sorted[i] = rectangles[order[i]];
+    int result = packer.pack(sorted.data(), count);
+    for (int i = 0; i < count; ++i)
+        copyRectanglePlacement(rectangles[order[i]], sorted[i]);
+    return result;
+}
+
+/// Searches for the minimum dimensions selected by sizeSelector, for which the rectangles fit, returns (0, 0) if there are none
+template <class Packer, class SizeSelector, typename RectangleType>
+static std::pair<int, int> packRectanglesWithSizeSelector(RectangleType *rectangles, int count, int spacing, SizeSelector &sizeSelector) {
+    std::vector<RectangleType> rectanglesCopy(count);
+    for (int i = 0; i < count; ++i) {
+        rectanglesCopy[i].w = rectangles[i].w+spacing;
+        rectanglesCopy[i].h = rectangles[i].h+spacing;
+    }
+    std::pair<int, int> dimensions;
+    int width, height;
+    while (sizeSelector(width, height)) {
+        if (!Packer(width+spacing, height+spacing).pack(rectanglesCopy.data(), count)) {
+            dimensions.first = width;
+            dimensions.second = height;
+            for (int i = 0; i < count; ++i)
+                copyRectanglePlacement(rectangles[i], rectanglesCopy[i]);
+            --sizeSelector;
+        } else
+            ++sizeSelector;
+    }
+    return dimensions;
+}
+
 template <typename RectangleType>
+int packRectangles(RectangleType *rectangles, int count, int width, int height, int spacing) {
+    return packRectangles<RectanglePacker>(rectangles, count, width, height, spacing);
+}
+
+template <class SizeSelector, typename RectangleType>
+std::pair<int, int> packRectangles(RectangleType *rectangles, int count, int spacing) {
+    return packRectangles<SizeSelector, RectanglePacker>(rectangles, count, spacing);
+}
+
+template <class Packer, typename RectangleType>
 int packRectangles(RectangleType *rectangles, int count, int width, int height, int spacing) {
     if (spacing)
         for (int i = 0; i < count; ++i) {
             rectangles[i].w += spacing;
             rectangles[i].h += spacing;
         }
-    int result = RectanglePacker(width+spacing, height+spacing).pack(rectangles, count);
+    int result = Packer(width+spacing, height+spacing).pack(rectangles, count);
     if (spacing)
         for (int i = 0; i < count; ++i) {
             rectangles[i].w -= spacing;
@@ -33,24 +109,132 @@ int packRectangles(RectangleType *rectangles, int count, int width, int height,
     return result;
 }
 
-template <class SizeSelector, typename RectangleType>
+template <class SizeSelector, class Packer, typename RectangleType>
 std::pair<int, int> packRectangles(RectangleType *rectangles, int count, int spacing) {
-    std::vector<RectangleType> rectanglesCopy(count);
+    int totalArea = 0;
+    for (int i = 0; i < count; ++i)
+        totalArea += rectangles[i].w*rectangles[i].h;
+    SizeSelector sizeSelector(totalArea);
+    return packRectanglesWithSizeSelector<Packer>(rectangles, count, spacing, sizeSelector);
+}
+
+template <typename RectangleType>
+std::pair<int, int> packRectanglesMinimumArea(RectangleType *rectangles, int count, int spacing, const double *aspectRatios, int aspectRatioCount, int maxWidth, int maxHeight, int threadCount) {
+    return packRectanglesMinimumArea<RectanglePacker>(rectangles, count, spacing, aspectRatios, aspectRatioCount, maxWidth, maxHeight, threadCount);
+}
+
+/// Area as the cost of atlas dimensions
+struct AtlasAreaCost {
+    long long operator()(int width, int height) const {
+        return (long long) width*height;
+    }
+};
+
+template <class Packer, typename RectangleType>
+std::pair<int, int> packRectanglesMinimumArea(RectangleType *rectangles, int count, int spacing, const double *aspectRatios, int aspectRatioCount, int maxWidth, int maxHeight, int threadCount) {
+    return packRectanglesMinimumCost<Packer>(rectangles, count, spacing, aspectRatios, aspectRatioCount, maxWidth, maxHeight, AtlasAreaCost(), threadCount);
+}
+
+template <class Packer, class CostFunction, typename RectangleType>
+std::pair<int, int> packRectanglesMinimumCost(RectangleType *rectangles, int count, int spacing, const double *aspectRatios, int aspectRatioCount, int maxWidth, int maxHeight, const CostFunction &cost, int threadCount) {
+    int totalArea = 0;
+    for (int i = 0; i < count; ++i)
+        totalArea += rectangles[i].w*rectangles[i].h;
+    std::vector<std::vector<RectangleType> > candidates(aspectRatioCount, std::vector<RectangleType>(rectangles, rectangles+count));
+    std::vector<std::pair<int, int> > results(aspectRatioCount);
+    std::vector<RectangleType> *candidateData = candidates.data();
+    std::pair<int, int> *resultData = results.data();
+    Workload(aspectRatioCount).setGrainSize(1).finish([candidateData, resultData, aspectRatios, count, spacing, totalArea, maxWidth, maxHeight](int i, int) -> bool {
+        AspectRatioSizeSelector sizeSelector(totalArea, aspectRatios[i], maxWidth, maxHeight);
+        resultData[i] = packRectanglesWithSizeSelector<Packer>(candidateData[i].data(), count, spacing, sizeSelector);
+        return true;
+    }, threadCount);
+    // The choice only depends on the results, not on which thread finished first
+    int best = -1;
+    for (int i = 0; i < aspectRatioCount; ++i) {
+        if (results[i].first > 0 && results[i].second > 0 && (best < 0 || cost(results[i].first, results[i].second) < cost(results[best].first, results[best].second)))
+            best = i;
+    }
+    if (best < 0)
+        return std::pair<int, int>();
+    // The aspect ratios are only samples, so the width and then the height of the best candidate are shrunk further separately
+    std::pair<int, int> dimensions = results[best];
+    std::vector<RectangleType> &placement = candidates[best];
+    std::vector<RectangleType> trial(placement);
+    for (int pass = 0; pass < 2; ++pass) {
+        int &side = pass ? dimensions.second : dimensions.first;
+        int otherSide = pass ? dimensions.first : dimensions.second;
+        int lowerBound = std::max((totalArea+otherSide-1)/otherSide, 1);
+        while (lowerBound < side) {
+            int current = lowerBound+(side-lowerBound)/2;
+            if (!packRectangles<Packer>(trial.data(), count, pass ? otherSide : current, pass ? current : otherSide, spacing)) {
+                side = current;
+                for (int i = 0; i < count; ++i)
+                    copyRectanglePlacement(placement[i], trial[i]);
+            } else
+                lowerBound = current+1;
+        }
+    }
+    for (int i = 0; i < count; ++i)
+        copyRectanglePlacement(rectangles[i], placement[i]);
+    return dimensions;
+}
+
+template <typename RectangleType>
+int packRectangles(RectangleType *rectangles, int count, int width, int height, int spacing, const PackingHeuristic *heuristics, int heuristicCount, int threadCount) {
+    if (heuristicCount <= 0)
+        return packRectangles(rectangles, count, width, height, spacing);
+    std::vector<std::vector<RectangleType> > candidates(heuristicCount, std::vector<RectangleType>(rectangles, rectangles+count));
+    for (std::vector<RectangleType> &candidate : candidates)
+        for (RectangleType &rect : candidate) {
+            rect.w += spacing;
+            rect.h += spacing;
+        }
+    std::vector<int> results(heuristicCount);
+    std::vector<RectangleType> *candidateData = candidates.data();
+    int *resultData = results.data();
+    Workload(heuristicCount).setGrainSize(1).finish([candidateData, resultData, heuristics, count, width, height, spacing](int i, int) -> bool {
+        resultData[i] = packRectanglesWithHeuristic(candidateData[i].data(), count, width+spacing, height+spacing, heuristics[i]);
+        return true;
+    }, threadCount);
+    // The choice only depends on the results, not on which thread finished first
+    int best = int(std::min_element(results.begin(), results.end())-results.begin());
+    for (int i = 0; i < count; ++i)
+        copyRectanglePlacement(rectangles[i], candidates[best][i]);
+    return results[best];
+}
+
+template <class SizeSelector, typename RectangleType>
+std::pair<int, int> packRectangles(RectangleType *rectangles, int count, int spacing, const PackingHeuristic *heuristics, int heuristicCount, int threadCount) {
+    if (heuristicCount <= 0)
+        return packRectangles<SizeSelector>(rectangles, count, spacing);
+    std::vector<std::vector<RectangleType> > candidates(heuristicCount, std::vector<RectangleType>(count));
     int totalArea = 0;
     for (int i = 0; i < count; ++i) {
-        rectanglesCopy[i].w = rectangles[i].w+spacing;
-        rectanglesCopy[i].h = rectangles[i].h+spacing;
+        for (std::vector<RectangleType> &candidate : candidates) {
+            candidate[i].w = rectangles[i].w+spacing;
+            candidate[i].h = rectangles[i].h+spacing;
+        }
         totalArea += rectangles[i].w*rectangles[i].h;
     }
+    std::vector<int> results(heuristicCount);
+    std::vector<RectangleType> *candidateData = candidates.data();
+    int *resultData = results.data();
     std::pair<int, int> dimensions;
     SizeSelector sizeSelector(totalArea);
     int width, height;
     while (sizeSelector(width, height)) {
-        if (!RectanglePacker(width+spacing, height+spacing).pack(rectanglesCopy.data(), count)) {
+        Workload(heuristicCount).setGrainSize(1).finish([candidateData, resultData, heuristics, count, &width, &height, spacing](int i, int) -> bool {
+            resultData[i] = packRectanglesWithHeuristic(candidateData[i].data(), count, width+spacing, height+spacing, heuristics[i]);
+            return true;
+        }, threadCount);
+        std::vector<int>::const_iterator fit = std::find(results.begin(), results.end(), 0);
+        if (fit != results.end()) {
+            const std::vector<RectangleType> &candidate = candidates[fit-results.begin()];
             dimensions.first = width;
             dimensions.second = height;
             for (int i = 0; i < count; ++i)
-                copyRectanglePlacement(rectangles[i], rectanglesCopy[i]);
+                copyRectanglePlacement(rectangles[i], candidate[i]);
             --sizeSelector;
         } else
             ++sizeSelector;
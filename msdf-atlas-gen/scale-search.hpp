@@ -0,0 +1,49 @@
+
+#pragma once
+
+#include <cmath>
+#include "CancellationToken.h"
+
+namespace msdf_atlas {
+
+/**
+ * Finds the largest scale (to the relative tolerance) for which fits(scale) returns true, assuming that it is monotonic.
+ * The search starts at seed and steps by initialRatio in the respective direction, squaring the ratio with each further step until the result is bracketed,
+ * which is then narrowed down by bisection in logarithmic space. The last call to fits is always with the returned scale, 0 is returned if none fits
+ */
+template <typename FitPredicate>
+double maximizeScale(FitPredicate fits, double seed, double initialRatio, double tolerance, const CancellationToken *cancellationToken) {
+    double minScale = 0, maxScale = 0;
+    bool lastResult = fits(seed);
+    if (lastResult)
+        minScale = seed;
+    else
+        maxScale = seed;
+    double ratio = initialRatio > 1+tolerance ? initialRatio : 1+tolerance;
+    while (!(minScale > 0 && maxScale > 0)) {
+        if (isCancelled(cancellationToken) || (maxScale > 0 && maxScale <= 1e-32))
+            return 0;
+        if (minScale >= 1e+32)
+            return minScale;
+        double nextScale = minScale > 0 ? minScale*ratio : maxScale/ratio;
+        if ((lastResult = fits(nextScale)))
+            minScale = nextScale;
+        else
+            maxScale = nextScale;
+        ratio = ratio < 256 ? ratio*ratio : ratio;
+    }
+    while (minScale/maxScale < 1-tolerance) {
+        if (isCancelled(cancellationToken))
+            return 0;
+        double midScale = sqrt(minScale*maxScale);
+        if ((lastResult = fits(midScale)))
+            minScale = midScale;
+        else
+            maxScale = midScale;
+    }
+    if (!lastResult)
+        fits(minScale);
+    return minScale;
+}
+
+}
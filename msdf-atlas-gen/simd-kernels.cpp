@@ -0,0 +1,328 @@
+
+#include "simd-kernels.h"
+
+#include <cstring>
+#include <core/pixel-conversion.hpp>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    #define MSDF_ATLAS_SIMD_X86
+    #include <immintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+        #define MSDF_ATLAS_TARGET(features)
+    #else
+        #define MSDF_ATLAS_TARGET(features) __attribute__((target(features)))
+    #endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define MSDF_ATLAS_SIMD_NEON
+    #include <arm_neon.h>
+#endif
+
+namespace msdf_atlas {
+
+// Scalar kernels
+
+static void floatToByteScalar(byte *dst, const float *src, size_t count) {
+    for (size_t i = 0; i < count; ++i)
+        dst[i] = msdfgen::pixelFloatToByte(src[i]);
+}
+
+static void byteSwap32Scalar(void *dst, const void *src, size_t count) {
+    const byte *s = reinterpret_cast<const byte *>(src);
+    byte *d = reinterpret_cast<byte *>(dst);
+    for (size_t i = 0; i < count; ++i, s += 4, d += 4) {
+        byte b[4] = { s[3], s[2], s[1], s[0] };
+        memcpy(d, b, 4);
+    }
+}
+
+static void rgbToRgbaScalar(byte *dst, const byte *src, size_t count) {
+    for (size_t i = 0; i < count; ++i, src += 3, dst += 4) {
+        dst[0] = src[0], dst[1] = src[1], dst[2] = src[2];
+        dst[3] = 255;
+    }
+}
+
+// The vector kernels compute 255 - trunc(255.5 - 255*clamp(x)), which is what pixelFloatToByte does,
+// max(x, 0) comes first so that NaN becomes 0 as in msdfgen::clamp
+
+#ifdef MSDF_ATLAS_SIMD_X86
+
+MSDF_ATLAS_TARGET("sse4.1")
+static __m128i floatToInt255Sse(__m128 x) {
+    __m128 v = _mm_min_ps(_mm_max_ps(x, _mm_setzero_ps()), _mm_set1_ps(1.f));
+    __m128i t = _mm_cvttps_epi32(_mm_sub_ps(_mm_set1_ps(255.5f), _mm_mul_ps(_mm_set1_ps(255.f), v)));
+    return _mm_sub_epi32(_mm_set1_epi32(255), t);
+}
+
+MSDF_ATLAS_TARGET("sse4.1")
+static void floatToByteSse41(byte *dst, const float *src, size_t count) {
+    size_t i = 0;
+    for (; i+16 <= count; i += 16) {
+        __m128i a = _mm_packus_epi32(floatToInt255Sse(_mm_loadu_ps(src+i)), floatToInt255Sse(_mm_loadu_ps(src+i+4)));
+        __m128i b = _mm_packus_epi32(floatToInt255Sse(_mm_loadu_ps(src+i+8)), floatToInt255Sse(_mm_loadu_ps(src+i+12)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst+i), _mm_packus_epi16(a, b));
+    }
+    floatToByteScalar(dst+i, src+i, count-i);
+}
+
+MSDF_ATLAS_TARGET("sse4.1")
+static void byteSwap32Sse41(void *dst, const void *src, size_t count) {
+    const __m128i shuffle = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    const byte *s = reinterpret_cast<const byte *>(src);
+    byte *d = reinterpret_cast<byte *>(dst);
+    size_t i = 0;
+    for (; i+4 <= count; i += 4)
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(d+4*i), _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(s+4*i)), shuffle));
+    byteSwap32Scalar(d+4*i, s+4*i, count-i);
+}
+
+MSDF_ATLAS_TARGET("sse4.1")
+static void rgbToRgbaSse41(byte *dst, const byte *src, size_t count) {
+    // Each step expands 4 pixels but loads 16 bytes, so it stops while 6 pixels remain to stay within the source
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alpha = _mm_set1_epi32(0xff000000);
+    size_t i = 0;
+    for (; i+6 <= count; i += 4)
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst+4*i), _mm_or_si128(_mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src+3*i)), shuffle), alpha));
+    rgbToRgbaScalar(dst+4*i, src+3*i, count-i);
+}
+
+MSDF_ATLAS_TARGET("avx2")
+static __m256i floatToInt255Avx2(__m256 x) {
+    __m256 v = _mm256_min_ps(_mm256_max_ps(x, _mm256_setzero_ps()), _mm256_set1_ps(1.f));
+    __m256i t = _mm256_cvttps_epi32(_mm256_sub_ps(_mm256_set1_ps(255.5f), _mm256_mul_ps(_mm256_set1_ps(255.f), v)));
+    return _mm256_sub_epi32(_mm256_set1_epi32(255), t);
+}
+
+MSDF_ATLAS_TARGET("avx2")
+static void floatToByteAvx2(byte *dst, const float *src, size_t count) {
+    // Packing works within 128-bit lanes, the final permutation restores the order of the 4-byte groups
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    size_t i = 0;
+    for (; i+32 <= count; i += 32) {
+        __m256i a = _mm256_packus_epi32(floatToInt255Avx2(_mm256_loadu_ps(src+i)), floatToInt255Avx2(_mm256_loadu_ps(src+i+8)));
+        __m256i b = _mm256_packus_epi32(floatToInt255Avx2(_mm256_loadu_ps(src+i+16)), floatToInt255Avx2(_mm256_loadu_ps(src+i+24)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst+i), _mm256_permutevar8x32_epi32(_mm256_packus_epi16(a, b), order));
+    }
+    floatToByteSse41(dst+i, src+i, count-i);
+}
+
+MSDF_ATLAS_TARGET("avx2")
+static void byteSwap32Avx2(void *dst, const void *src, size_t count) {
+    const __m256i shuffle = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    const byte *s = reinterpret_cast<const byte *>(src);
+    byte *d = reinterpret_cast<byte *>(dst);
+    size_t i = 0;
+    for (; i+8 <= count; i += 8)
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(d+4*i), _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(s+4*i)), shuffle));
+    byteSwap32Sse41(d+4*i, s+4*i, count-i);
+}
+
+MSDF_ATLAS_TARGET("avx512f")
+static void floatToByteAvx512(byte *dst, const float *src, size_t count) {
+    size_t i = 0;
+    for (; i+16 <= count; i += 16) {
+        __m512 v = _mm512_min_ps(_mm512_max_ps(_mm512_loadu_ps(src+i), _mm512_setzero_ps()), _mm512_set1_ps(1.f));
+        __m512i t = _mm512_cvttps_epi32(_mm512_sub_ps(_mm512_set1_ps(255.5f), _mm512_mul_ps(_mm512_set1_ps(255.f), v)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst+i), _mm512_cvtepi32_epi8(_mm512_sub_epi32(_mm512_set1_epi32(255), t)));
+    }
+    floatToByteAvx2(dst+i, src+i, count-i);
+}
+
+static bool cpuSupports(SimdLevel level) {
+    #ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        int maxLeaf = info[0];
+        __cpuid(info, 1);
+        bool sse41 = (info[2]&(1<<19)) != 0;
+        bool osxsave = (info[2]&(1<<27)) != 0;
+        unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+        bool avxState = (xcr0&0x06) == 0x06, avx512State = (xcr0&0xe6) == 0xe6;
+        bool avx2 = false, avx512 = false;
+        if (maxLeaf >= 7) {
+            __cpuidex(info, 7, 0);
+            avx2 = avxState && (info[1]&(1<<5)) != 0;
+            avx512 = avx512State && (info[1]&(1<<16)) != 0;
+        }
+        switch (level) {
+            case SimdLevel::SSE41:
+                return sse41;
+            case SimdLevel::AVX2:
+                return sse41 && avx2;
+            case SimdLevel::AVX512:
+                return sse41 && avx2 && avx512;
+            default:
+                return false;
+        }
+    #else
+        __builtin_cpu_init();
+        switch (level) {
+            case SimdLevel::SSE41:
+                return __builtin_cpu_supports("sse4.1");
+            case SimdLevel::AVX2:
+                return __builtin_cpu_supports("sse4.1") && __builtin_cpu_supports("avx2");
+            case SimdLevel::AVX512:
+                return __builtin_cpu_supports("sse4.1") && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("avx512f");
+            default:
+                return false;
+        }
+    #endif
+}
+
+#endif
+
+#ifdef MSDF_ATLAS_SIMD_NEON
+
+static void floatToByteNeon(byte *dst, const float *src, size_t count) {
+    const float32x4_t zero = vdupq_n_f32(0.f), one = vdupq_n_f32(1.f), k255 = vdupq_n_f32(255.f), k2555 = vdupq_n_f32(255.5f);
+    const int32x4_t k255i = vdupq_n_s32(255);
+    size_t i = 0;
+    for (; i+8 <= count; i += 8) {
+        int32x4_t r[2];
+        for (int j = 0; j < 2; ++j) {
+            float32x4_t v = vminq_f32(vmaxnmq_f32(vld1q_f32(src+i+4*j), zero), one);
+            r[j] = vsubq_s32(k255i, vcvtq_s32_f32(vsubq_f32(k2555, vmulq_f32(k255, v))));
+        }
+        vst1_u8(dst+i, vqmovn_u16(vcombine_u16(vqmovun_s32(r[0]), vqmovun_s32(r[1]))));
+    }
+    floatToByteScalar(dst+i, src+i, count-i);
+}
+
+static void byteSwap32Neon(void *dst, const void *src, size_t count) {
+    const byte *s = reinterpret_cast<const byte *>(src);
+    byte *d = reinterpret_cast<byte *>(dst);
+    size_t i = 0;
+    for (; i+4 <= count; i += 4)
+        vst1q_u8(d+4*i, vrev32q_u8(vld1q_u8(s+4*i)));
+    byteSwap32Scalar(d+4*i, s+4*i, count-i);
+}
+
+static void rgbToRgbaNeon(byte *dst, const byte *src, size_t count) {
+    size_t i = 0;
+    for (; i+16 <= count; i += 16) {
+        uint8x16x3_t rgb = vld3q_u8(src+3*i);
+        uint8x16x4_t rgba = { { rgb.val[0], rgb.val[1], rgb.val[2], vdupq_n_u8(255) } };
+        vst4q_u8(dst+4*i, rgba);
+    }
+    rgbToRgbaScalar(dst+4*i, src+3*i, count-i);
+}
+
+#endif
+
+struct SimdKernels {
+    SimdLevel level;
+    void (*floatToByte)(byte *dst, const float *src, size_t count);
+    void (*byteSwap32)(void *dst, const void *src, size_t count);
+    void (*rgbToRgba)(byte *dst, const byte *src, size_t count);
+};
+
+static SimdKernels kernelsOfLevel(SimdLevel level) {
+    SimdKernels kernels = { SimdLevel::SCALAR, &floatToByteScalar, &byteSwap32Scalar, &rgbToRgbaScalar };
+    switch (level) {
+    #ifdef MSDF_ATLAS_SIMD_X86
+        case SimdLevel::SSE41:
+            kernels = SimdKernels { level, &floatToByteSse41, &byteSwap32Sse41, &rgbToRgbaSse41 };
+            break;
+        case SimdLevel::AVX2:
+            kernels = SimdKernels { level, &floatToByteAvx2, &byteSwap32Avx2, &rgbToRgbaSse41 };
+            break;
+        case SimdLevel::AVX512:
+            kernels = SimdKernels { level, &floatToByteAvx512, &byteSwap32Avx2, &rgbToRgbaSse41 };
+            break;
+    #endif
+    #ifdef MSDF_ATLAS_SIMD_NEON
+        case SimdLevel::NEON:
+            kernels = SimdKernels { level, &floatToByteNeon, &byteSwap32Neon, &rgbToRgbaNeon };
+            break;
+    #endif
+        default:;
+    }
+    return kernels;
+}
+
+bool isSimdLevelSupported(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::SCALAR:
+            return true;
+    #ifdef MSDF_ATLAS_SIMD_X86
+        case SimdLevel::SSE41:
+        case SimdLevel::AVX2:
+        case SimdLevel::AVX512:
+            return cpuSupports(level);
+    #endif
+    #ifdef MSDF_ATLAS_SIMD_NEON
+        case SimdLevel::NEON:
+            return true;
+    #endif
+        default:
+            return false;
+    }
+}
+
+SimdLevel detectSimdLevel() {
+    static const SimdLevel detected = []() -> SimdLevel {
+        const SimdLevel candidates[] = { SimdLevel::AVX512, SimdLevel::AVX2, SimdLevel::SSE41, SimdLevel::NEON };
+        for (SimdLevel level : candidates)
+            if (isSimdLevelSupported(level))
+                return level;
+        return SimdLevel::SCALAR;
+    }();
+    return detected;
+}
+
+/// Selected at startup, may be overridden by setSimdLevel before starting any work
+static SimdKernels kernels = kernelsOfLevel(detectSimdLevel());
+
+bool setSimdLevel(SimdLevel level) {
+    if (!isSimdLevelSupported(level))
+        return false;
+    kernels = kernelsOfLevel(level);
+    return true;
+}
+
+SimdLevel getSimdLevel() {
+    return kernels.level;
+}
+
+const char *simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::SCALAR:
+            return "scalar";
+        case SimdLevel::SSE41:
+            return "sse4.1";
+        case SimdLevel::AVX2:
+            return "avx2";
+        case SimdLevel::AVX512:
+            return "avx512";
+        case SimdLevel::NEON:
+            return "neon";
+    }
+    return "";
+}
+
+bool parseSimdLevel(SimdLevel &level, const char *name) {
+    const SimdLevel levels[] = { SimdLevel::SCALAR, SimdLevel::SSE41, SimdLevel::AVX2, SimdLevel::AVX512, SimdLevel::NEON };
+    for (SimdLevel candidate : levels) {
+        if (!strcmp(name, simdLevelName(candidate))) {
+            level = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+void convertFloatToByte(byte *dst, const float *src, size_t count) {
+    kernels.floatToByte(dst, src, count);
+}
+
+void swapByteOrder32(void *dst, const void *src, size_t count) {
+    kernels.byteSwap32(dst, src, count);
+}
+
+void expandRgbToRgba(byte *dst, const byte *src, size_t count) {
+    kernels.rgbToRgba(dst, src, count);
+}
+
+}
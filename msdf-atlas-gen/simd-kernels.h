@@ -0,0 +1,39 @@
+
+#pragma once
+
+#include <cstddef>
+#include "types.h"
+
+namespace msdf_atlas {
+
+/// Instruction set extension used by the optimized kernels
+enum class SimdLevel {
+    /// Portable scalar code
+    SCALAR,
+    SSE41,
+    AVX2,
+    AVX512,
+    NEON
+};
+
+/// Returns the highest level supported by both the CPU and the build, detected once
+SimdLevel detectSimdLevel();
+/// Returns true if the level is supported by both the CPU and the build
+bool isSimdLevelSupported(SimdLevel level);
+/// Selects the kernels of the given level instead of the detected one, returns false (and keeps the selection) if not supported
+bool setSimdLevel(SimdLevel level);
+/// Returns the level of the currently selected kernels
+SimdLevel getSimdLevel();
+/// Returns the name of the level as accepted by parseSimdLevel
+const char *simdLevelName(SimdLevel level);
+/// Parses the name of a level (scalar, sse4.1, avx2, avx512, neon)
+bool parseSimdLevel(SimdLevel &level, const char *name);
+
+/// Converts floating-point values to bytes, equivalent to msdfgen::pixelFloatToByte
+void convertFloatToByte(byte *dst, const float *src, size_t count);
+/// Reverses the byte order of 32-bit values, dst may equal src
+void swapByteOrder32(void *dst, const void *src, size_t count);
+/// Expands count 3-channel byte pixels to 4 channels with the fourth channel set to 255
+void expandRgbToRgba(byte *dst, const byte *src, size_t count);
+
+}
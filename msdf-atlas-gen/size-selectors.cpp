@@ -2,6 +2,8 @@
 #include "size-selectors.h"
 
 #include <cmath>
+#include <climits>
+#include <algorithm>
 
 namespace msdf_atlas {
 
@@ -44,6 +46,51 @@ template class SquareSizeSelector<1>;
 template class SquareSizeSelector<2>;
 template class SquareSizeSelector<4>;
 
+AspectRatioSizeSelector::AspectRatioSizeSelector(int minArea, double aspectRatio, int maxWidth, int maxHeight) : aspectRatio(aspectRatio), maxSide(-1), lowerBound(1), upperBound(-1) {
+    if (minArea > 0)
+        lowerBound = std::max(int(ceil(sqrt(minArea/aspectRatio))), 1);
+    // The search is over the height, which is limited so that the width fits as well
+    if (maxWidth > 0 || maxHeight > 0) {
+        maxSide = maxHeight > 0 ? maxHeight : INT_MAX;
+        if (maxWidth > 0) {
+            maxSide = std::min(maxSide, int(maxWidth/aspectRatio));
+            while (maxSide > 0 && widthFor(maxSide) > maxWidth)
+                --maxSide;
+        }
+    }
+    updateCurrent();
+}
+
+int AspectRatioSizeSelector::widthFor(int height) const {
+    return std::max(int(ceil(aspectRatio*height)), 1);
+}
+
+void AspectRatioSizeSelector::updateCurrent() {
+    if (upperBound < 0)
+        current = 5*lowerBound/4+17;
+    else
+        current = lowerBound+(upperBound-lowerBound)/2;
+    if (maxSide >= 0 && current > maxSide)
+        current = maxSide;
+}
+
+bool AspectRatioSizeSelector::operator()(int &width, int &height) const {
+    width = widthFor(current), height = current;
+    return (lowerBound < upperBound || upperBound < 0) && (maxSide < 0 || lowerBound <= maxSide);
+}
+
+AspectRatioSizeSelector &AspectRatioSizeSelector::operator++() {
+    lowerBound = current+1;
+    updateCurrent();
+    return *this;
+}
+
+AspectRatioSizeSelector &AspectRatioSizeSelector::operator--() {
+    upperBound = current;
+    updateCurrent();
+    return *this;
+}
+
 SquarePowerOfTwoSizeSelector::SquarePowerOfTwoSizeSelector(int minArea) : side(1) {
     while (side*side < minArea)
         side <<= 1;
@@ -23,6 +23,26 @@ private:
 
 };
 
+/// Selects dimensions with a fixed aspect ratio (width / height), which do not exceed maxWidth x maxHeight (if positive)
+class AspectRatioSizeSelector {
+
+public:
+    explicit AspectRatioSizeSelector(int minArea = 0, double aspectRatio = 1, int maxWidth = 0, int maxHeight = 0);
+    bool operator()(int &width, int &height) const;
+    AspectRatioSizeSelector &operator++();
+    AspectRatioSizeSelector &operator--();
+
+private:
+    double aspectRatio;
+    int maxSide;
+    int lowerBound, upperBound;
+    int current;
+
+    int widthFor(int height) const;
+    void updateCurrent();
+
+};
+
 /// Selects square power-of-two dimensions
 class SquarePowerOfTwoSizeSelector {
 
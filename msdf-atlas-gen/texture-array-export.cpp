@@ -0,0 +1,321 @@
+
+#include "texture-array-export.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include "Workload.h"
+#include "simd-kernels.h"
+
+namespace msdf_atlas {
+
+// Vulkan format identifiers of the layers (VkFormat)
+#define VK_FORMAT_R8_UNORM 9u
+#define VK_FORMAT_R8G8B8A8_UNORM 37u
+#define VK_FORMAT_R32_SFLOAT 100u
+#define VK_FORMAT_R32G32B32A32_SFLOAT 109u
+#define VK_FORMAT_BC4_UNORM_BLOCK 139u
+
+// Values of the basic data format descriptor block (Khronos Data Format Specification)
+#define KHR_DF_MODEL_RGBSDA 1u
+#define KHR_DF_MODEL_BC4 131u
+#define KHR_DF_PRIMARIES_BT709 1u
+#define KHR_DF_TRANSFER_LINEAR 1u
+#define KHR_DF_CHANNEL_ALPHA 15u
+#define KHR_DF_SAMPLE_DATATYPE_SIGNED 0x40u
+#define KHR_DF_SAMPLE_DATATYPE_FLOAT 0x80u
+
+static const byte KTX2_IDENTIFIER[12] = { 0xab, 'K', 'T', 'X', ' ', '2', '0', 0xbb, '\r', '\n', 0x1a, '\n' };
+
+struct LayerFormat {
+    unsigned vkFormat;
+    int typeSize;
+    /// Width and height of a texel block and its size in bytes (blocks are 1 x 1 if uncompressed)
+    int blockDimension, blockBytes;
+    int channels;
+};
+
+static LayerFormat getLayerFormat(TextureArrayCompression compression, bool floatingPoint, int channels) {
+    LayerFormat format = { };
+    switch (compression) {
+        case TextureArrayCompression::NONE:
+            // There are no widely supported 3-channel formats, so MSDF is stored in 4 channels
+            format.channels = channels == 1 ? 1 : 4;
+            if (floatingPoint)
+                format.vkFormat = format.channels == 1 ? VK_FORMAT_R32_SFLOAT : VK_FORMAT_R32G32B32A32_SFLOAT;
+            else
+                format.vkFormat = format.channels == 1 ? VK_FORMAT_R8_UNORM : VK_FORMAT_R8G8B8A8_UNORM;
+            format.typeSize = floatingPoint ? 4 : 1;
+            format.blockDimension = 1;
+            format.blockBytes = format.typeSize*format.channels;
+            break;
+        case TextureArrayCompression::BC4:
+            format.vkFormat = VK_FORMAT_BC4_UNORM_BLOCK;
+            format.typeSize = 1;
+            format.blockDimension = 4;
+            format.blockBytes = 8;
+            format.channels = 1;
+            break;
+    }
+    return format;
+}
+
+/// Detects the byte order of the host at runtime, as not all compilers define a macro for it
+static bool isBigEndian() {
+    const unsigned value = 1;
+    byte firstByte;
+    memcpy(&firstByte, &value, 1);
+    return !firstByte;
+}
+
+static void writeUint32(std::vector<byte> &output, unsigned value) {
+    for (int i = 0; i < 4; ++i)
+        output.push_back((byte) (value>>8*i));
+}
+
+static void writeUint64(std::vector<byte> &output, unsigned long long value) {
+    for (int i = 0; i < 8; ++i)
+        output.push_back((byte) (value>>8*i));
+}
+
+static void writeDataFormatDescriptor(std::vector<byte> &output, const LayerFormat &format, TextureArrayCompression compression, bool floatingPoint) {
+    bool bc4 = compression == TextureArrayCompression::BC4;
+    int sampleCount = bc4 ? 1 : format.channels;
+    unsigned blockSize = 24+16*sampleCount;
+    writeUint32(output, 4+blockSize); // dfdTotalSize
+    writeUint32(output, 0); // vendorId = Khronos, descriptorType = basic
+    writeUint32(output, 2u|blockSize<<16); // versionNumber = 1.3
+    writeUint32(output, (bc4 ? KHR_DF_MODEL_BC4 : KHR_DF_MODEL_RGBSDA)|KHR_DF_PRIMARIES_BT709<<8|KHR_DF_TRANSFER_LINEAR<<16);
+    unsigned blockDimension = format.blockDimension-1;
+    writeUint32(output, blockDimension|blockDimension<<8);
+    writeUint32(output, format.blockBytes); // bytesPlane0
+    writeUint32(output, 0);
+    if (bc4) {
+        writeUint32(output, 63u<<16); // 64 bits of BC4 data
+        writeUint32(output, 0);
+        writeUint32(output, 0);
+        writeUint32(output, 0xffffffffu);
+    } else {
+        unsigned bits = 8*format.typeSize;
+        for (int i = 0; i < sampleCount; ++i) {
+            unsigned channelType = i < 3 ? (unsigned) i : KHR_DF_CHANNEL_ALPHA;
+            if (floatingPoint)
+                channelType |= KHR_DF_SAMPLE_DATATYPE_SIGNED|KHR_DF_SAMPLE_DATATYPE_FLOAT;
+            writeUint32(output, i*bits|(bits-1)<<16|channelType<<24);
+            writeUint32(output, 0);
+            writeUint32(output, floatingPoint ? 0xbf800000u : 0u); // -1.0f
+            writeUint32(output, floatingPoint ? 0x3f800000u : 255u); // 1.0f
+        }
+    }
+}
+
+static void writeKeyValue(std::vector<byte> &output, const char *key, const char *value) {
+    size_t keyLength = strlen(key)+1, valueLength = strlen(value)+1;
+    writeUint32(output, (unsigned) (keyLength+valueLength));
+    output.insert(output.end(), key, key+keyLength);
+    output.insert(output.end(), value, value+valueLength);
+    while (output.size()&3)
+        output.push_back(0);
+}
+
+static void setOpaque(byte &value) {
+    value = 255;
+}
+
+static void setOpaque(float &value) {
+    value = 1;
+}
+
+static byte toByte(byte value) {
+    return value;
+}
+
+static byte toByte(float value) {
+    return msdfgen::pixelFloatToByte(value);
+}
+
+/// Returns the atlas row of the layer's row-th row in the order given by the Y direction
+static int sourceRow(const Rectangle &rect, int row, YDirection yDirection) {
+    return yDirection == YDirection::TOP_DOWN ? rect.y+rect.h-1-row : rect.y+row;
+}
+
+/// Copies w pixels to a layer row, adding an opaque fourth channel to 3-channel pixels
+template <typename T, int N>
+static void copyLayerRow(byte *dst, const T *src, int w) {
+    const int M = N == 1 ? 1 : 4;
+    if (M == N) {
+        memcpy(dst, src, sizeof(T)*N*w);
+        return;
+    }
+    for (int x = 0; x < w; ++x) {
+        T pixel[M];
+        for (int i = 0; i < N; ++i)
+            pixel[i] = src[N*x+i];
+        setOpaque(pixel[M-1]);
+        memcpy(dst+sizeof(T)*M*x, pixel, sizeof(pixel));
+    }
+}
+
+template <>
+void copyLayerRow<byte, 3>(byte *dst, const byte *src, int w) {
+    expandRgbToRgba(dst, src, (size_t) w);
+}
+
+template <typename T, int N>
+static void copyLayer(byte *dst, const msdfgen::BitmapConstRef<T, N> &atlas, const Rectangle &rect, int layerWidth, int layerHeight, YDirection yDirection) {
+    const int M = N == 1 ? 1 : 4;
+    int w = std::min(rect.w, layerWidth), h = std::min(rect.h, layerHeight);
+    for (int y = 0; y < h; ++y)
+        copyLayerRow<T, N>(dst+sizeof(T)*M*layerWidth*y, atlas(rect.x, sourceRow(rect, y, yDirection)), w);
+}
+
+static void encodeBC4Block(byte *dst, const byte *values) {
+    byte lo = 255, hi = 0;
+    for (int i = 0; i < 16; ++i) {
+        lo = std::min(lo, values[i]);
+        hi = std::max(hi, values[i]);
+    }
+    // The first endpoint being greater selects the mode with 6 values interpolated between the endpoints
+    dst[0] = hi, dst[1] = lo;
+    unsigned long long indices = 0;
+    if (hi > lo) {
+        int range = hi-lo;
+        for (int i = 0; i < 16; ++i) {
+            // Nearest of the 8 evenly spaced values from lo (0) to hi (7), index 0 is hi, index 1 is lo, and indices 2 to 7 go from hi to lo
+            int step = (14*(values[i]-lo)+range)/(2*range);
+            int index = step == 7 ? 0 : step == 0 ? 1 : 8-step;
+            indices |= (unsigned long long) index<<3*i;
+        }
+    }
+    for (int i = 0; i < 6; ++i)
+        dst[2+i] = (byte) (indices>>8*i);
+}
+
+template <typename T, int N>
+static void encodeBC4Layer(byte *dst, const msdfgen::BitmapConstRef<T, N> &atlas, const Rectangle &rect, int layerWidth, int layerHeight, YDirection yDirection) {
+    std::vector<byte> pixels((size_t) layerWidth*layerHeight);
+    int w = std::min(rect.w, layerWidth), h = std::min(rect.h, layerHeight);
+    for (int y = 0; y < h; ++y) {
+        const T *src = atlas(rect.x, sourceRow(rect, y, yDirection));
+        for (int x = 0; x < w; ++x)
+            pixels[(size_t) layerWidth*y+x] = toByte(src[N*x]);
+    }
+    // Blocks beyond the edge of the layer replicate its last row and column
+    byte block[16];
+    for (int by = 0; by < layerHeight; by += 4) {
+        for (int bx = 0; bx < layerWidth; bx += 4) {
+            for (int i = 0; i < 16; ++i)
+                block[i] = pixels[(size_t) layerWidth*std::min(by+(i>>2), layerHeight-1)+std::min(bx+(i&3), layerWidth-1)];
+            encodeBC4Block(dst, block);
+            dst += 8;
+        }
+    }
+}
+
+int getGridCellIndex(const GlyphGeometry &glyph, int cellWidth, int cellHeight, int columns, int atlasHeight) {
+    if (glyph.isWhitespace() || !(cellWidth > 0 && cellHeight > 0))
+        return -1;
+    // The grid is filled row by row from the top, each box is at the bottom left corner of its cell
+    Rectangle rect = glyph.getBoxRect();
+    return ((atlasHeight-rect.y)/cellHeight-1)*columns+rect.x/cellWidth;
+}
+
+template <typename T, int N>
+bool exportTextureArray(const GlyphGeometry *glyphs, int glyphCount, const msdfgen::BitmapConstRef<T, N> &atlas, const char *filename, const TextureArrayExportProperties &properties) {
+    TextureArrayCompression compression = properties.compression;
+    if (compression == TextureArrayCompression::BC4 && N != 1)
+        return false;
+    bool floatingPoint = compression == TextureArrayCompression::NONE && std::is_floating_point<T>::value;
+
+    // The boxes of a uniform grid are all the same size, each layer is one box
+    int layerCount = 0, layerWidth = 0, layerHeight = 0;
+    for (int i = 0; i < glyphCount; ++i) {
+        int layer = getGridCellIndex(glyphs[i], properties.cellWidth, properties.cellHeight, properties.columns, atlas.height);
+        if (layer >= 0) {
+            Rectangle rect = glyphs[i].getBoxRect();
+            layerCount = std::max(layerCount, layer+1);
+            layerWidth = std::max(layerWidth, rect.w);
+            layerHeight = std::max(layerHeight, rect.h);
+        }
+    }
+    if (!(layerCount > 0 && layerWidth > 0 && layerHeight > 0))
+        return false;
+
+    LayerFormat format = getLayerFormat(compression, floatingPoint, N);
+    size_t layerBytes = (size_t) ((layerWidth+format.blockDimension-1)/format.blockDimension)*((layerHeight+format.blockDimension-1)/format.blockDimension)*format.blockBytes;
+    std::vector<byte> levelData(layerBytes*layerCount);
+    byte *levelPtr = levelData.data();
+    int cellWidth = properties.cellWidth, cellHeight = properties.cellHeight, columns = properties.columns;
+    YDirection yDirection = properties.yDirection;
+    // Each glyph's box is copied or compressed from the atlas into its own layer, so the layers are independent
+    Workload(glyphCount).finish([glyphs, &atlas, levelPtr, layerBytes, layerWidth, layerHeight, cellWidth, cellHeight, columns, yDirection, compression](int i, int) -> bool {
+        int layer = getGridCellIndex(glyphs[i], cellWidth, cellHeight, columns, atlas.height);
+        if (layer >= 0) {
+            Rectangle rect = glyphs[i].getBoxRect();
+            switch (compression) {
+                case TextureArrayCompression::NONE:
+                    copyLayer(levelPtr+layerBytes*layer, atlas, rect, layerWidth, layerHeight, yDirection);
+                    break;
+                case TextureArrayCompression::BC4:
+                    encodeBC4Layer(levelPtr+layerBytes*layer, atlas, rect, layerWidth, layerHeight, yDirection);
+                    break;
+            }
+        }
+        return true;
+    }, properties.threadCount);
+    // Floating-point texels are stored little-endian
+    if (floatingPoint && isBigEndian())
+        swapByteOrder32(levelPtr, levelPtr, levelData.size()/4);
+
+    std::vector<byte> dfd, kvd;
+    writeDataFormatDescriptor(dfd, format, compression, floatingPoint);
+    // Keys are sorted
+    writeKeyValue(kvd, "KTXorientation", yDirection == YDirection::TOP_DOWN ? "rd" : "ru");
+    writeKeyValue(kvd, "KTXwriter", "msdf-atlas-gen");
+
+    // Identifier, header, index and the level index of the single mip level
+    size_t dfdOffset = sizeof(KTX2_IDENTIFIER)+9*4+4*4+2*8+3*8;
+    size_t kvdOffset = dfdOffset+dfd.size();
+    size_t dataAlignment = std::max(format.blockBytes, 4);
+    size_t dataOffset = (kvdOffset+kvd.size()+dataAlignment-1)/dataAlignment*dataAlignment;
+    std::vector<byte> header(KTX2_IDENTIFIER, KTX2_IDENTIFIER+sizeof(KTX2_IDENTIFIER));
+    writeUint32(header, format.vkFormat);
+    writeUint32(header, format.typeSize);
+    writeUint32(header, layerWidth);
+    writeUint32(header, layerHeight);
+    writeUint32(header, 0); // pixelDepth
+    writeUint32(header, layerCount);
+    writeUint32(header, 1); // faceCount
+    writeUint32(header, 1); // levelCount
+    writeUint32(header, 0); // supercompressionScheme
+    writeUint32(header, (unsigned) dfdOffset);
+    writeUint32(header, (unsigned) dfd.size());
+    writeUint32(header, (unsigned) kvdOffset);
+    writeUint32(header, (unsigned) kvd.size());
+    writeUint64(header, 0); // sgdByteOffset
+    writeUint64(header, 0); // sgdByteLength
+    writeUint64(header, dataOffset);
+    writeUint64(header, levelData.size());
+    writeUint64(header, levelData.size()); // uncompressedByteLength
+    header.insert(header.end(), dfd.begin(), dfd.end());
+    header.insert(header.end(), kvd.begin(), kvd.end());
+    header.resize(dataOffset);
+
+    bool success = false;
+    if (FILE *f = fopen(filename, "wb")) {
+        success = fwrite(header.data(), 1, header.size(), f) == header.size() && fwrite(levelData.data(), 1, levelData.size(), f) == levelData.size();
+        fclose(f);
+    }
+    return success;
+}
+
+template bool exportTextureArray(const GlyphGeometry *glyphs, int glyphCount, const msdfgen::BitmapConstRef<byte, 1> &atlas, const char *filename, const TextureArrayExportProperties &properties);
+template bool exportTextureArray(const GlyphGeometry *glyphs, int glyphCount, const msdfgen::BitmapConstRef<byte, 3> &atlas, const char *filename, const TextureArrayExportProperties &properties);
+template bool exportTextureArray(const GlyphGeometry *glyphs, int glyphCount, const msdfgen::BitmapConstRef<byte, 4> &atlas, const char *filename, const TextureArrayExportProperties &properties);
+template bool exportTextureArray(const GlyphGeometry *glyphs, int glyphCount, const msdfgen::BitmapConstRef<float, 1> &atlas, const char *filename, const TextureArrayExportProperties &properties);
+template bool exportTextureArray(const GlyphGeometry *glyphs, int glyphCount, const msdfgen::BitmapConstRef<float, 3> &atlas, const char *filename, const TextureArrayExportProperties &properties);
+template bool exportTextureArray(const GlyphGeometry *glyphs, int glyphCount, const msdfgen::BitmapConstRef<float, 4> &atlas, const char *filename, const TextureArrayExportProperties &properties);
+
+}
@@ -0,0 +1,34 @@
+
+#pragma once
+
+#include <msdfgen.h>
+#include "types.h"
+#include "GlyphGeometry.h"
+
+namespace msdf_atlas {
+
+/// Storage format of the layers of an exported texture array
+enum class TextureArrayCompression {
+    /// 8-bit or 32-bit floating-point channels as in the atlas, 3-channel atlases are stored in 4 channels
+    NONE,
+    /// BC4 block compression (single-channel atlases only)
+    BC4
+};
+
+struct TextureArrayExportProperties {
+    /// Layout of the uniform grid the glyphs were packed into
+    int cellWidth, cellHeight;
+    int columns;
+    TextureArrayCompression compression;
+    YDirection yDirection;
+    int threadCount;
+};
+
+/// Returns the index of the uniform grid cell the glyph's box is placed in, which is also its texture array layer, or -1 for whitespace
+int getGridCellIndex(const GlyphGeometry &glyph, int cellWidth, int cellHeight, int columns, int atlasHeight);
+
+/// Copies each glyph's box of a uniform grid atlas into its layer of a 2D texture array and saves it as a KTX2 file
+template <typename T, int N>
+bool exportTextureArray(const GlyphGeometry *glyphs, int glyphCount, const msdfgen::BitmapConstRef<T, N> &atlas, const char *filename, const TextureArrayExportProperties &properties);
+
+}
@@ -64,7 +64,9 @@ enum class DimensionsConstraint {
     EVEN_SQUARE,
     MULTIPLE_OF_FOUR_SQUARE,
     POWER_OF_TWO_RECTANGLE,
-    POWER_OF_TWO_SQUARE
+    POWER_OF_TWO_SQUARE,
+    /// Any dimensions which minimize the modeled GPU memory (see GpuMemoryModel), treated as NONE by the grid packer
+    MINIMUM_MEMORY
 };
 
 }
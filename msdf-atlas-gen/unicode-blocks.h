@@ -0,0 +1,17 @@
+
+#pragma once
+
+#include "types.h"
+
+namespace msdf_atlas {
+
+/// A named block of the Unicode codespace
+struct UnicodeBlock {
+    unicode_t first, last;
+    const char *name;
+};
+
+/// Returns the Unicode block that contains the codepoint, or null if it does not belong to any block
+const UnicodeBlock *findUnicodeBlock(unicode_t codepoint);
+
+}
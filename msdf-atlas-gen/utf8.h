@@ -1,6 +1,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <vector>
 #include "types.h"
 
@@ -8,5 +9,12 @@ namespace msdf_atlas {
 
 /// Decodes the UTF-8 string into an array of Unicode codepoints
 void utf8Decode(std::vector<unicode_t> &codepoints, const char *utf8String);
+/// Decodes the UTF-8 string of the given length (in bytes) into an array of Unicode codepoints
+void utf8Decode(std::vector<unicode_t> &codepoints, const char *utf8String, size_t length);
+/// Decodes the UTF-8 string of the given length (in bytes), calling callback(unicode_t) for each codepoint
+template <typename FN>
+void utf8DecodeEach(FN &&callback, const char *utf8String, size_t length);
 
 }
+
+#include "utf8.hpp"
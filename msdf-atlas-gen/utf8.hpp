@@ -0,0 +1,39 @@
+
+#pragma once
+
+namespace msdf_atlas {
+
+template <typename FN>
+void utf8DecodeEach(FN &&callback, const char *utf8String, size_t length) {
+    bool start = true;
+    int rBytes = 0;
+    unicode_t cp = 0;
+
+    for (const char *c = utf8String, *end = utf8String+length; c < end; ++c) {
+        if (rBytes > 0) {
+            --rBytes;
+            if ((*c&0xc0) == 0x80)
+                cp |= (*c&0x3f)<<(6*rBytes);
+            // else error
+        } else if (!(*c&0x80)) {
+            cp = *c;
+            rBytes = 0;
+        } else if (*c&0x40) {
+            int block;
+            for (block = 0; ((unsigned char) *c<<block)&0x40 && block < 4; ++block);
+            if (block < 4) {
+                cp = (*c&(0x3f>>block))<<(6*block);
+                rBytes = block;
+            } else
+                continue; // error
+        } else
+            continue; // error
+        if (!rBytes) {
+            if (!(start && cp == 0xfeff)) // BOM
+                callback(cp);
+            start = false;
+        }
+    }
+}
+
+}